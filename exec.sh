@@ -21,11 +21,29 @@ export stat_after=1.0e+2
 export coef_dt_adv=0.35
 export coef_dt_dif=0.95
 
+## number of cells in x per tile of the stencil sweeps
+## 0 to tune automatically for each sweep
+export tile_size=0
+
+## planning rigour of FFTW, whose result is cached under output/
+## 0: estimate, 1: measure, 2: patient, 3: exhaustive
+export fftw_rigour=2
+
+## Poisson solver
+## 0: FFT-based, 1: multigrid (only neighbouring processes communicate)
+export poisson_solver=0
+
 ## physical parameters
 export Ra=1.0e+8
 export Pr=1.0e+1
 export We=4.0e+3
 
+## threads per process, which are pinned
+## so that the first-touch placement of the arrays is kept
+export OMP_NUM_THREADS=1
+export OMP_PROC_BIND=close
+export OMP_PLACES=cores
+
 # give name of the directory in which the initial conditions
 #   (incl. domain size etc.) are stored as an argument
 dirname_ic=initial_condition/output
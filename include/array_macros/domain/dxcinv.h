@@ -0,0 +1,10 @@
+#if !defined(INCLUDE_ARRAY_MACROS_DOMAIN_DXCINV_H)
+#define INCLUDE_ARRAY_MACROS_DOMAIN_DXCINV_H
+
+// This file is generated by tools/define_arrays.py
+
+// [1 : isize+1]
+#define DXCINV(I) (dxcinv[(I-1)])
+#define DXCINV_NADDS (int [2]){0, 1}
+
+#endif // INCLUDE_ARRAY_MACROS_DOMAIN_DXCINV_H
@@ -0,0 +1,10 @@
+#if !defined(INCLUDE_ARRAY_MACROS_DOMAIN_DXFINV_H)
+#define INCLUDE_ARRAY_MACROS_DOMAIN_DXFINV_H
+
+// This file is generated by tools/define_arrays.py
+
+// [1 : isize+0]
+#define DXFINV(I) (dxfinv[(I-1)])
+#define DXFINV_NADDS (int [2]){0, 0}
+
+#endif // INCLUDE_ARRAY_MACROS_DOMAIN_DXFINV_H
@@ -0,0 +1,10 @@
+#if !defined(INCLUDE_ARRAY_MACROS_DOMAIN_WXP_H)
+#define INCLUDE_ARRAY_MACROS_DOMAIN_WXP_H
+
+// This file is generated by tools/define_arrays.py
+
+// [2 : isize+0]
+#define WXP(I) (wxp[(I-2)])
+#define WXP_NADDS (int [2]){-1, 0}
+
+#endif // INCLUDE_ARRAY_MACROS_DOMAIN_WXP_H
@@ -0,0 +1,12 @@
+#if !defined(INCLUDE_ARRAY_MACROS_INTERFACE_BAND_H)
+#define INCLUDE_ARRAY_MACROS_INTERFACE_BAND_H
+
+// This file is generated by tools/define_arrays.py
+
+// [0 : jsize+1]
+#define BRANGES(J) (branges[(J  )])
+#define BOFFSETS(J) (boffsets[(J  )])
+#define BAND_NADDS (int [NDIMS][2]){ {0, 0}, {1, 1}, }
+
+
+#endif // INCLUDE_ARRAY_MACROS_INTERFACE_BAND_H
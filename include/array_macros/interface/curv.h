@@ -3,9 +3,8 @@
 
 // This file is generated by tools/define_arrays.py
 
-// [0 : isize+1], [0 : jsize+1]
-#define CURV(I, J) (curv[(I  ) + (isize+2) * (J  )])
-#define CURV_NADDS (int [NDIMS][2]){ {1, 1}, {1, 1}, }
+// [branges[row][0] : branges[row][1]], [0 : jsize+1], band-packed
+#define CURV(I, J) (curv[boffsets[(J  )] + (I) - branges[(J  )][0]])
 
 
 #endif // INCLUDE_ARRAY_MACROS_INTERFACE_CURV_H
@@ -0,0 +1,11 @@
+#if !defined(INCLUDE_ARRAY_MACROS_INTERFACE_DCACHE_H)
+#define INCLUDE_ARRAY_MACROS_INTERFACE_DCACHE_H
+
+// This file is generated by tools/define_arrays.py
+
+// [1 : isize+0], [0 : jsize+1]
+#define DCACHE(I, J) (dcache[(I-1) + (isize+0) * (J  )])
+#define DCACHE_NADDS (int [NDIMS][2]){ {0, 0}, {1, 1}, }
+
+
+#endif // INCLUDE_ARRAY_MACROS_INTERFACE_DCACHE_H
@@ -1,11 +0,0 @@
-#if !defined(INCLUDE_ARRAY_MACROS_INTERFACE_IFRCX_H)
-#define INCLUDE_ARRAY_MACROS_INTERFACE_IFRCX_H
-
-// This file is generated by tools/define_arrays.py
-
-// [2 : isize+0], [1 : jsize+0]
-#define IFRCX(I, J) (ifrcx[(I-2) + (isize-1) * (J-1)])
-#define IFRCX_NADDS (int [NDIMS][2]){ {-1, 0}, {0, 0}, }
-
-
-#endif // INCLUDE_ARRAY_MACROS_INTERFACE_IFRCX_H
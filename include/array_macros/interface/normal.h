@@ -3,9 +3,8 @@
 
 // This file is generated by tools/define_arrays.py
 
-// [1 : isize+0], [0 : jsize+1]
-#define NORMAL(I, J) (normal[(I-1) + (isize+0) * (J  )])
-#define NORMAL_NADDS (int [NDIMS][2]){ {0, 0}, {1, 1}, }
+// [branges[row][0] : branges[row][1]], [0 : jsize+1], band-packed, SoA
+#define NORMAL(I, J, N) (normal[(N)][boffsets[(J  )] + (I) - branges[(J  )][0]])
 
 
 #endif // INCLUDE_ARRAY_MACROS_INTERFACE_NORMAL_H
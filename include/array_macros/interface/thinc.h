@@ -0,0 +1,10 @@
+#if !defined(INCLUDE_ARRAY_MACROS_INTERFACE_THINC_H)
+#define INCLUDE_ARRAY_MACROS_INTERFACE_THINC_H
+
+// This file is generated by tools/define_arrays.py
+
+// [branges[row][0] : branges[row][1]], [0 : jsize+1], band-packed
+#define THINC(I, J) (thinc[boffsets[(J  )] + (I) - branges[(J  )][0]])
+
+
+#endif // INCLUDE_ARRAY_MACROS_INTERFACE_THINC_H
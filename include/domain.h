@@ -14,7 +14,10 @@
  * @var lengths  : domain size in each direction
  * @var xf, xc   : cell-face and cell-center locations in x direction
  * @var dxf, dxc : face-to-face and center-to-center distances in x direction
+ * @var dxfinv, dxcinv : reciprocals of dxf and dxc
+ * @var wxm, wxp : weights to interpolate cell-center values to x faces
  * @var dy, dz   : grid sizes in homogeneous directions
+ * @var dyinv    : reciprocal of dy
  */
 typedef struct {
   sdecomp_info_t * info;
@@ -24,7 +27,10 @@ typedef struct {
   double lengths[NDIMS];
   double * restrict xf, * restrict xc;
   double * restrict dxf, * restrict dxc;
+  double * restrict dxfinv, * restrict dxcinv;
+  double * restrict wxm, * restrict wxp;
   double dy;
+  double dyinv;
 } domain_t;
 
 // constructor
@@ -14,6 +14,7 @@
  * @var srcux        : Runge-Kutta source terms for ux
  * @var srcuy        : Runge-Kutta source terms for uy
  * @var srcuz        : Runge-Kutta source terms for uz
+ *                      N.B. [rk_b] are not allocated in the low-storage mode
  * @var Ra, Pr       : non-dimensional parameters
  * @var m_dif, t_dif : momentum / temperature diffusivities
  */
@@ -27,13 +27,20 @@ extern int fluid_decide_dt(
     double * dt
 );
 
+// compute right-hand-side terms of the Runge-Kutta scheme
+extern int fluid_compute_rhs(
+    const domain_t * domain,
+    const size_t rkstep,
+    fluid_t * fluid,
+    const interface_t * interface
+);
+
 // predict the new velocity field and update the temperature field
 extern int fluid_predict_field(
     const domain_t * domain,
     const size_t rkstep,
     const double dt,
-    fluid_t * fluid,
-    const interface_t * interface
+    fluid_t * fluid
 );
 
 // compute scalar potential by solving Poisson equation
@@ -54,6 +61,15 @@ extern int fluid_compute_potential_dct(
     fluid_t * fluid
 );
 
+// compute scalar potential by solving Poisson equation
+// (multigrid version, mainly neighbouring processes communicate)
+extern int fluid_compute_potential_mg(
+    const domain_t * domain,
+    const size_t rkstep,
+    const double dt,
+    fluid_t * fluid
+);
+
 // correct velocity field using scalar potential
 extern int fluid_correct_velocity(
     const domain_t * domain,
@@ -10,16 +10,76 @@ typedef double vector_t[NDIMS];
 //   which is stored at the last
 typedef double normal_t[NDIMS + 1];
 
+// narrow band, in which the interface is reconstructed
+//   and band-packed quantities (normal, curv) are stored
+/**
+ * @struct band_t
+ * @brief per-row index ranges of interfacial cells and their stencil neighbours
+ * @var ranges   : [is, ie] of each row, empty when is > ie
+ * @var offsets  : position of the first cell of each row in band-packed buffers
+ * @var nitems   : total number of cells in the band
+ * @var capacity : number of cells which band-packed buffers can hold
+ */
+typedef struct {
+  int (* ranges)[2];
+  int * offsets;
+  size_t nitems;
+  size_t capacity;
+} band_t;
+
+// maximum number of Newton-Raphson iterations to find intercepts
+#define INTERFACE_NITERSMAX 8
+
+// row buffers of a thread, which walks a chunk of rows
+typedef struct {
+  // corner normals of two consecutive rows,
+  //   used as a sliding window when the curvature tensor is computed,
+  //   each component is stored separately
+  double * dvof[2][NDIMS];
+  // face-averaged vof at the negative and positive faces
+  //   of the cells in a row, used as upwind values of the fluxes
+  double * fvof[2];
+  // vof fluxes of the row being updated,
+  //   x faces and lower / upper y faces
+  double * flxx;
+  double * flxy[2];
+} interface_rows_t;
+
 typedef struct {
   array_t vof;
-  array_t ifrcx;
-  array_t ifrcy;
-  array_t dvof;
-  array_t normal;
-  array_t curv;
-  array_t flxx;
-  array_t flxy;
-  array_t src[2];
+  band_t band;
+  // row buffers, one set per thread
+  interface_rows_t * rows;
+  // y fluxes at the lower faces of the chunks of rows, one per thread,
+  //   which are computed before any cell is updated
+  //   and are shared by the two neighbouring chunks
+  double ** edges;
+  // band-packed normal components and intercept,
+  //   each of which is stored separately
+  double * normal[NDIMS + 1];
+  double * curv;
+  // exponential factors of the THINC function,
+  //   whose type (thinc_t) is private to the interface solver
+  void * thinc;
+  // x fluxes at the right faces of a tile, one per row,
+  //   which are re-used as the left faces of the next tile
+  //   since the cells there have already been updated
+  double * seam;
+  // Runge-Kutta source term of the vof field,
+  //   the previous one is read before being overwritten in-place
+  array_t src;
+  // velocity averaged over a time step,
+  //   used when vof is advected once per step
+  array_t ux;
+  array_t uy;
+  // intercepts (exp(-2 beta d)) found previously,
+  //   re-used as the initial guesses of the Newton-Raphson iterations,
+  //   only used (and allocated) with the warm start
+  array_t dcache;
+  // histogram of the number of Newton-Raphson iterations
+  //   accumulated from the beginning,
+  //   the last bin counts the cells which did not converge
+  size_t niters[INTERFACE_NITERSMAX + 1];
   double tension;
 } interface_t;
 
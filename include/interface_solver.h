@@ -22,14 +22,21 @@ extern int interface_compute_curvature_tensor(
     interface_t * interface
 );
 
-extern int interface_compute_force(
+extern int interface_update_vof(
     const domain_t * domain,
+    const size_t rkstep,
+    const double dt,
+    const fluid_t * fluid,
     interface_t * interface
 );
 
-extern int interface_update_vof(
+extern int interface_store_velocity(
+    const fluid_t * fluid,
+    interface_t * interface
+);
+
+extern int interface_update_vof_once(
     const domain_t * domain,
-    const size_t rkstep,
     const double dt,
     const fluid_t * fluid,
     interface_t * interface
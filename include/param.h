@@ -21,6 +21,61 @@ extern const bool param_m_implicit_y;
 extern const bool param_t_implicit_x;
 extern const bool param_t_implicit_y;
 
+/* interface.c */
+// flag to specify how the THINC function is evaluated
+// true : exponential factors are computed once per cell and re-used
+//          by the intercept solver and the flux quadrature
+// false: reference implementation, exp is called at each quadrature point
+// NOTE: the two agree only up to round-off errors,
+//   and thus switching this flag changes results slightly
+extern const bool param_interface_reuse_exponentials;
+// flag to specify how often the vof field is advected
+// true : once per time step, using velocity averaged over the step,
+//          surface tension force is evaluated from the frozen interface
+// false: at every Runge-Kutta stage
+extern const bool param_interface_once_per_step;
+// flags to specify the initial guesses of the intercepts,
+//   Newton-Raphson iterations stop when the volume-fraction residual
+//   is below 1e-12 or after INTERFACE_NITERSMAX iterations,
+//   and the latter are counted in the last bin of the histogram
+// warm start: intercept found previously in the same cell is re-used
+// NOTE: off by default, since D = exp(-2 beta d) moves by 20 % or more
+//         within a stage, which needs more iterations than the closed form
+//         and leaves some cells unconverged
+extern const bool param_interface_warm_start;
+// closed form: approximate solution for NGAUSS = 2,
+//   used when no previous solution is available
+extern const bool param_interface_closed_form_guess;
+
+/* predict.c */
+// flag to specify how the right-hand-side terms of the predictor are computed
+// true : ux, uy and T are processed together in one sweep,
+//          sharing the interpolated advecting velocities
+// false: each component is processed separately
+extern const bool param_predict_combined_rhs;
+
+/* runge-kutta.c */
+// flag to specify how the Runge-Kutta source terms are stored
+// true : low-storage mode, the previous explicit terms are carried over
+//          in the slot of the implicit terms, saving one array per field
+//          at the cost of round-off differences
+// false: explicit, previous explicit, and implicit terms are stored separately
+extern const bool param_rk_low_storage;
+
+/* poisson.c */
+// number of batches into which the pencils of the Poisson solvers are split,
+//   so that the transforms and the tri-diagonal solves of a batch
+//   overlap with the all-to-all communications of the others
+// 1: each pencil is transposed at once
+// NOTE: a single batch is always used when only one process is launched
+extern const int param_poisson_nbatches;
+// multigrid solver, selected by the user at runtime
+// V-cycles are repeated until the maximum residual
+//   relative to the maximum right-hand side is below the tolerance
+extern const double param_poisson_mg_tolerance;
+// upper limit of the V-cycles per solve
+extern const int param_poisson_mg_maxcycles;
+
 /* boundary-condition.c */
 // NOTE: changing values may break the Nusselt balance
 // NOTE: impermeable walls and Neumann BC for the pressure are unchangeable
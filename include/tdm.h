@@ -2,9 +2,14 @@
 #define TDM_H
 
 #include <stdbool.h>
+#include <stddef.h>
 
 typedef struct tdm_info_t_ tdm_info_t;
 
+// factorisation of a matrix, which can be shared by several tdm_info_t
+//   of the same size and periodicity
+typedef struct tdm_factor_t_ tdm_factor_t;
+
 typedef struct {
   int (* const construct)(
       const int size,
@@ -33,10 +38,28 @@ typedef struct {
       const tdm_info_t * info,
       int * nrhs
   );
-  int (* const solve)(
+  int (* const factorise)(
+      const tdm_info_t * info,
+      tdm_factor_t ** factor
+  );
+  int (* const solve_factorised)(
       const tdm_info_t * info,
+      const tdm_factor_t * factor,
       void * restrict data
   );
+  int (* const solve_factorised_strided)(
+      const tdm_info_t * info,
+      const tdm_factor_t * factor,
+      const size_t stride,
+      void * restrict data
+  );
+  int (* const solve)(
+      tdm_info_t * info,
+      void * restrict data
+  );
+  int (* const destruct_factor)(
+      tdm_factor_t * factor
+  );
   int (* const destruct)(
       tdm_info_t * info
   );
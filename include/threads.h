@@ -0,0 +1,27 @@
+#if !defined(THREADS_H)
+#define THREADS_H
+
+// OpenMP directive, which vanishes when built without OpenMP
+//   so that the pure-MPI build is free of unknown pragmas
+#if defined(_OPENMP)
+#define THREADS_PRAGMA(...) _Pragma(#__VA_ARGS__)
+#else
+#define THREADS_PRAGMA(...)
+#endif
+
+// initialise threading, which is called once after MPI is launched
+extern int threads_init(
+    void
+);
+
+// number of threads which work in parallel regions
+extern int threads_get_nthreads(
+    void
+);
+
+// index of the calling thread, [0 : nthreads - 1]
+extern int threads_get_mythread(
+    void
+);
+
+#endif // THREADS_H
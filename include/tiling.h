@@ -0,0 +1,57 @@
+#if !defined(TILING_H)
+#define TILING_H
+
+#include <stdbool.h>
+#include "domain.h"
+
+// maximum number of tile sizes examined by the autotuner
+#define TILING_NCANDSMAX 7
+
+// column-block tiling of a sequence of row-wise kernels:
+//   the cells [1 : isize] are split into the tiles [is : ie],
+//   each of which is swept by all kernels of the sequence in turn
+//   so that the rows of the tile stay in cache between the kernels
+// NOTE: each kernel derives its own range from the tile,
+//   e.g. the x faces [max(is, 2) : ie] for ux,
+//   and refers to the neighbouring cells (halo of the tile) as usual
+/**
+ * @struct tiling_t
+ * @brief tile size of a kernel sequence and its autotuning state
+ * @var name           : name of the kernel sequence, used for reporting
+ * @var is_initialised : tile size is decided or autotuning is started
+ * @var size           : number of cells in x per tile
+ * @var is_tuning      : candidates are being timed
+ * @var ncands         : number of candidates
+ * @var cands          : candidate tile sizes
+ * @var wtimes         : shortest wall time of each candidate
+ * @var cand           : index of the candidate being timed
+ * @var nsamples       : number of samples of the current candidate
+ * @var tic            : wall time when the current sample started
+ */
+typedef struct {
+  const char * name;
+  bool is_initialised;
+  int size;
+  bool is_tuning;
+  size_t ncands;
+  int cands[TILING_NCANDSMAX];
+  double wtimes[TILING_NCANDSMAX];
+  size_t cand;
+  size_t nsamples;
+  double tic;
+} tiling_t;
+
+// give the tile size of this sweep
+extern int tiling_begin(
+    const domain_t * domain,
+    tiling_t * tiling,
+    int * size
+);
+
+// finish the sweep, which is timed when autotuning
+extern int tiling_end(
+    const domain_t * domain,
+    tiling_t * tiling
+);
+
+#endif // TILING_H
@@ -6,6 +6,7 @@
 #include "domain.h"
 #include "array.h"
 #include "fileio.h"
+#include "threads.h"
 
 static int prepare(
     const domain_t * domain,
@@ -42,6 +43,16 @@ static int prepare(
   }
   array->datasize = nitems * size;
   array->data = memory_calloc(nitems, size);
+  // first touch by the threads, which decides the NUMA node of each page:
+  //   rows are distributed in the same manner as the kernels
+  //   (static schedule in y), so that each thread mostly works on local memory
+  const int nrows = mysizes[1] + nadds[1][0] + nadds[1][1];
+  const size_t rowsize = array->datasize / nrows;
+  char * data = array->data;
+  THREADS_PRAGMA(omp parallel for schedule(static))
+  for(int j = 0; j < nrows; j++){
+    memset(data + rowsize * j, 0, rowsize);
+  }
   return 0;
 }
 
@@ -11,6 +11,10 @@
 #include "array_macros/domain/xc.h"
 #include "array_macros/domain/dxf.h"
 #include "array_macros/domain/dxc.h"
+#include "array_macros/domain/dxfinv.h"
+#include "array_macros/domain/dxcinv.h"
+#include "array_macros/domain/wxm.h"
+#include "array_macros/domain/wxp.h"
 
 /**
  * @brief load members in domain_t
@@ -142,6 +146,88 @@ static double * allocate_and_init_dxc(
   return dxc;
 }
 
+/**
+ * @brief define reciprocals of face-to-face distances in x direction
+ * @param[in] isize : number of cell-centers in x direction (boundary excluded)
+ * @param[in] dxf   : face-to-face distances in x direction
+ * @return          : reciprocals of face-to-face distances
+ */
+static double * allocate_and_init_dxfinv(
+    const int isize,
+    const double * dxf
+){
+  // dxfinv: 1 / dxf, to avoid divisions in the stencil loops
+  const size_t nitems = isize;
+  double * dxfinv = memory_calloc(nitems, sizeof(double));
+  for(size_t i = 1; i <= nitems; i++){
+    DXFINV(i  ) = 1. / DXF(i  );
+  }
+  return dxfinv;
+}
+
+/**
+ * @brief define reciprocals of center-to-center distances in x direction
+ * @param[in] isize : number of cell-centers in x direction (boundary excluded)
+ * @param[in] dxc   : center-to-center distances in x direction
+ * @return          : reciprocals of center-to-center distances
+ */
+static double * allocate_and_init_dxcinv(
+    const int isize,
+    const double * dxc
+){
+  // dxcinv: 1 / dxc, to avoid divisions in the stencil loops
+  const size_t nitems = isize + 1;
+  double * dxcinv = memory_calloc(nitems, sizeof(double));
+  for(size_t i = 1; i <= nitems; i++){
+    DXCINV(i  ) = 1. / DXC(i  );
+  }
+  return dxcinv;
+}
+
+/**
+ * @brief define weights to interpolate cell-center values to x faces
+ * @param[in] isize : number of cell-centers in x direction (boundary excluded)
+ * @param[in] dxf   : face-to-face distances in x direction
+ * @param[in] dxc   : center-to-center distances in x direction
+ * @return          : weights of the negative-side cell centers
+ */
+static double * allocate_and_init_wxm(
+    const int isize,
+    const double * dxf,
+    const double * dxc
+){
+  // NOTE: defined at the internal cell faces,
+  //   which have "isize - 1" elements, whose index starts from 2
+  const size_t nitems = isize - 1;
+  double * wxm = memory_calloc(nitems, sizeof(double));
+  for(size_t i = 2; i <= nitems + 1; i++){
+    WXM(i  ) = 0.5 * DXF(i-1) / DXC(i  );
+  }
+  return wxm;
+}
+
+/**
+ * @brief define weights to interpolate cell-center values to x faces
+ * @param[in] isize : number of cell-centers in x direction (boundary excluded)
+ * @param[in] dxf   : face-to-face distances in x direction
+ * @param[in] dxc   : center-to-center distances in x direction
+ * @return          : weights of the positive-side cell centers
+ */
+static double * allocate_and_init_wxp(
+    const int isize,
+    const double * dxf,
+    const double * dxc
+){
+  // NOTE: defined at the internal cell faces,
+  //   which have "isize - 1" elements, whose index starts from 2
+  const size_t nitems = isize - 1;
+  double * wxp = memory_calloc(nitems, sizeof(double));
+  for(size_t i = 2; i <= nitems + 1; i++){
+    WXP(i  ) = 0.5 * DXF(i  ) / DXC(i  );
+  }
+  return wxp;
+}
+
 static void report(
     const domain_t * domain
 ){
@@ -171,16 +257,21 @@ int domain_init(
     const char dirname_ic[],
     domain_t * domain
 ){
-  sdecomp_info_t ** info    = &domain->info;
-  size_t * restrict glsizes =  domain->glsizes;
-  size_t * restrict mysizes =  domain->mysizes;
-  size_t * restrict offsets =  domain->offsets;
-  double * restrict lengths =  domain->lengths;
-  double * restrict * xf    = &domain->xf;
-  double * restrict * xc    = &domain->xc;
-  double * restrict * dxf   = &domain->dxf;
-  double * restrict * dxc   = &domain->dxc;
-  double * restrict   dy    = &domain->dy;
+  sdecomp_info_t ** info     = &domain->info;
+  size_t * restrict glsizes  =  domain->glsizes;
+  size_t * restrict mysizes  =  domain->mysizes;
+  size_t * restrict offsets  =  domain->offsets;
+  double * restrict lengths  =  domain->lengths;
+  double * restrict * xf     = &domain->xf;
+  double * restrict * xc     = &domain->xc;
+  double * restrict * dxf    = &domain->dxf;
+  double * restrict * dxc    = &domain->dxc;
+  double * restrict * dxfinv = &domain->dxfinv;
+  double * restrict * dxcinv = &domain->dxcinv;
+  double * restrict * wxm    = &domain->wxm;
+  double * restrict * wxp    = &domain->wxp;
+  double * restrict   dy     = &domain->dy;
+  double * restrict   dyinv  = &domain->dyinv;
   // load spatial information
   if(0 != domain_load(dirname_ic, domain)){
     return 1;
@@ -189,8 +280,14 @@ int domain_init(
   // allocate and initialise x coordinates
   *dxf = allocate_and_init_dxf(glsizes[0], *xf);
   *dxc = allocate_and_init_dxc(glsizes[0], *xc);
+  // metrics used by the stencil loops
+  *dxfinv = allocate_and_init_dxfinv(glsizes[0], *dxf);
+  *dxcinv = allocate_and_init_dxcinv(glsizes[0], *dxc);
+  *wxm = allocate_and_init_wxm(glsizes[0], *dxf, *dxc);
+  *wxp = allocate_and_init_wxp(glsizes[0], *dxf, *dxc);
   // grid sizes in homogeneous directions
   *dy = lengths[1] / glsizes[1];
+  *dyinv = 1. / *dy;
   // initialise sdecomp to distribute the domain
   if(0 != sdecomp.construct(
         MPI_COMM_WORLD,
@@ -9,10 +9,10 @@
 #include "runge_kutta.h"
 #include "domain.h"
 #include "tdm.h"
+#include "threads.h"
 #include "fluid.h"
 #include "fluid_solver.h"
-#include "array_macros/domain/dxf.h"
-#include "array_macros/domain/dxc.h"
+#include "internal.h"
 #include "array_macros/fluid/ux.h"
 #include "array_macros/fluid/uy.h"
 #include "array_macros/fluid/psi.h"
@@ -26,12 +26,17 @@ typedef struct {
   bool is_initialised;
   void * restrict buf0;
   void * restrict buf1;
-  fftw_plan fftw_plan_x[2];
+  // forward transforms, one per batch of the x1 pencil,
+  //   and backward transform of the whole x1 pencil
+  fftw_plan * fftw_plan_x_forward;
+  fftw_plan fftw_plan_x_backward;
   size_t tdm_sizes[2];
   tdm_info_t * tdm_info;
+  tdm_factor_t ** tdm_factors;
   double * evals;
-  sdecomp_transpose_plan_t * r_transposer_x1_to_y1;
-  sdecomp_transpose_plan_t * r_transposer_y1_to_x1;
+  int nbatches;
+  pipeline_t * r_pipeline_x1_to_y1;
+  pipeline_t * r_pipeline_y1_to_x1;
 } poisson_solver_t;
 
 /* initialise Poisson solver */
@@ -150,9 +155,12 @@ static int init_tri_diagonal_solver(
   //   independent to y, z directions and time,
   //   we compute here and re-use them
   // center-diagonal components are, on the other hand,
-  //   dependent on time and thus needs to compute everytime
-  //   in the solver
+  //   dependent on the wave number,
+  //   see init_tri_diagonal_factors
   size_t * restrict tdm_sizes = poisson_solver->tdm_sizes;
+  // one solver is shared by all threads,
+  //   which holds the matrix factorised for each wave number
+  //   and is only read by the substitutions
   tdm_info_t ** tdm_info = &poisson_solver->tdm_info;
   // in y: d^2p / dy^2 = q
   tdm_sizes[0] = r_y1pncl_sizes[1];
@@ -181,52 +189,84 @@ static int init_pencil_rotations(
     const domain_t * domain,
     poisson_solver_t * poisson_solver
 ){
-  const sdecomp_info_t * info = domain->info;
+  // pencils are rotated batch by batch,
+  //   rows of the x1 pencil and columns of the y1 pencil, respectively
   const size_t r_dsize = sizeof(double);
-  if(0 != sdecomp.transpose.construct(info, SDECOMP_X1PENCIL, SDECOMP_Y1PENCIL, r_gl_sizes, r_dsize, &poisson_solver->r_transposer_x1_to_y1)){
+  if(0 != pipeline_construct(domain, SDECOMP_X1PENCIL, r_gl_sizes, r_dsize, &poisson_solver->r_pipeline_x1_to_y1)){
     report_failure("SDECOMP x1 to y1 for real");
     return 1;
   }
-  if(0 != sdecomp.transpose.construct(info, SDECOMP_Y1PENCIL, SDECOMP_X1PENCIL, r_gl_sizes, r_dsize, &poisson_solver->r_transposer_y1_to_x1)){
+  if(0 != pipeline_construct(domain, SDECOMP_Y1PENCIL, r_gl_sizes, r_dsize, &poisson_solver->r_pipeline_y1_to_x1)){
     report_failure("SDECOMP y1 to x1 for real");
     return 1;
   }
+  pipeline_get_nbatches(poisson_solver->r_pipeline_x1_to_y1, &poisson_solver->nbatches);
   return 0;
 }
 
 static int init_ffts(
+    const domain_t * domain,
     poisson_solver_t * poisson_solver
 ){
-  const unsigned flags = FFTW_PATIENT | FFTW_DESTROY_INPUT;
+  // planning rigour is given by the user,
+  //   and the wisdom cached by the previous runs is re-used
+  wisdom_t wisdom = {0};
+  if(0 != wisdom_begin(domain, "dct", &wisdom)){
+    return 1;
+  }
+  const unsigned flags = wisdom.flags | FFTW_DESTROY_INPUT;
+#if defined(_OPENMP)
+  // transforms are executed by all threads of this process
+  fftw_plan_with_nthreads(threads_get_nthreads());
+#endif
   // NOTE: two buffers should be properly given
   //   see "allocate_buffers" above
   // x, real to real
   {
     const int signal_length = r_x1pncl_sizes[SDECOMP_XDIR];
     const int repeat_for = r_x1pncl_sizes[SDECOMP_YDIR];
-    fftw_plan * fplan = &poisson_solver->fftw_plan_x[0];
-    fftw_plan * bplan = &poisson_solver->fftw_plan_x[1];
-    *fplan = fftw_plan_many_r2r(
-        1, &signal_length, repeat_for,
-        poisson_solver->buf0, NULL, 1, signal_length,
-        poisson_solver->buf1, NULL, 1, signal_length,
-        (fftw_r2r_kind [1]){FFTW_REDFT10}, flags
-    );
+    // forward, rows in each batch
+    //   so that the batch is sent while the next one is transformed
+    const int nbatches = poisson_solver->nbatches;
+    poisson_solver->fftw_plan_x_forward = memory_calloc(nbatches, sizeof(fftw_plan));
+    for(int k = 0; k < nbatches; k++){
+      fftw_plan * fplan = poisson_solver->fftw_plan_x_forward + k;
+      size_t b = 0;
+      size_t e = 0;
+      pipeline_get_batch(poisson_solver->r_pipeline_x1_to_y1, k, &b, &e);
+      *fplan = NULL;
+      if(b == e){
+        // no rows in this batch
+        continue;
+      }
+      *fplan = fftw_plan_many_r2r(
+          1, &signal_length, e - b,
+          (double *)poisson_solver->buf0 + b * signal_length, NULL, 1, signal_length,
+          (double *)poisson_solver->buf1 + b * signal_length, NULL, 1, signal_length,
+          (fftw_r2r_kind [1]){FFTW_REDFT10}, flags
+      );
+      if(NULL == *fplan){
+        report_failure("FFTW x-forward");
+        return 1;
+      }
+    }
+    // backward, all rows at once
+    fftw_plan * bplan = &poisson_solver->fftw_plan_x_backward;
     *bplan = fftw_plan_many_r2r(
         1, &signal_length, repeat_for,
         poisson_solver->buf1, NULL, 1, signal_length,
         poisson_solver->buf0, NULL, 1, signal_length,
         (fftw_r2r_kind [1]){FFTW_REDFT01}, flags
     );
-    if(NULL == *fplan){
-      report_failure("FFTW x-forward");
-      return 1;
-    }
     if(NULL == *bplan){
       report_failure("FFTW x-backward");
       return 1;
     }
   }
+  // cache the wisdom for the next launch
+  if(0 != wisdom_end(domain, &wisdom)){
+    return 1;
+  }
   return 0;
 }
 
@@ -260,6 +300,35 @@ static int init_eigenvalues(
   return 0;
 }
 
+static int init_tri_diagonal_factors(
+    poisson_solver_t * poisson_solver
+){
+  // the matrix of each wave number does not change in time,
+  //   and thus is factorised here once
+  //   so that only substitutions are needed in the solver
+  const size_t size_of_system = poisson_solver->tdm_sizes[0];
+  const size_t repeat_for     = poisson_solver->tdm_sizes[1];
+  const double * restrict evals = poisson_solver->evals;
+  poisson_solver->tdm_factors = memory_calloc(repeat_for, sizeof(tdm_factor_t *));
+  tdm_factor_t ** tdm_factors = poisson_solver->tdm_factors;
+  tdm_info_t * tdm_info = poisson_solver->tdm_info;
+  double * restrict tdm_l = NULL;
+  double * restrict tdm_u = NULL;
+  double * restrict tdm_c = NULL;
+  tdm.get_l(tdm_info, &tdm_l);
+  tdm.get_u(tdm_info, &tdm_u);
+  tdm.get_c(tdm_info, &tdm_c);
+  for(size_t m = 0; m < repeat_for; m++){
+    // set center diagonal components
+    for(size_t n = 0; n < size_of_system; n++){
+      tdm_c[n] = - tdm_l[n] - tdm_u[n] + evals[m];
+    }
+    tdm_factors[m] = NULL;
+    if(0 != tdm.factorise(tdm_info, tdm_factors + m)) return 1;
+  }
+  return 0;
+}
+
 static int init_poisson_solver(
     const domain_t * domain,
     poisson_solver_t * poisson_solver
@@ -270,8 +339,9 @@ static int init_poisson_solver(
   if(0 != allocate_buffers(poisson_solver))                 return 1;
   if(0 != init_tri_diagonal_solver(domain, poisson_solver)) return 1;
   if(0 != init_pencil_rotations(domain, poisson_solver))    return 1;
-  if(0 != init_ffts(poisson_solver))                        return 1;
+  if(0 != init_ffts(domain, poisson_solver))                return 1;
   if(0 != init_eigenvalues(domain, poisson_solver))         return 1;
+  if(0 != init_tri_diagonal_factors(poisson_solver))        return 1;
   poisson_solver->is_initialised = true;
   const int root = 0;
   int myrank = root;
@@ -291,23 +361,26 @@ static int assign_input(
 ){
   const int isize = domain->mysizes[0];
   const int jsize = domain->mysizes[1];
-  const double * restrict dxf = domain->dxf;
-  const double dy = domain->dy;
+  // NOTE: this solver is only used for uniform x grids,
+  //   whose metric is constant
+  const double dxinv = domain->dxfinv[0];
+  const double dyinv = domain->dyinv;
   const double * restrict ux = fluid->ux.data;
   const double * restrict uy = fluid->uy.data;
   // normalise FFT beforehand
   const double norm = 2. * domain->glsizes[0];
   const double prefactor = 1. / (rkcoefs[rkstep][rk_g] * dt) / norm;
-  for(int cnt = 0, j = 1; j <= jsize; j++){
-    for(int i = 1; i <= isize; i++, cnt++){
-      const double dx = DXF(i  );
+  THREADS_PRAGMA(omp parallel for schedule(static))
+  for(int j = 1; j <= jsize; j++){
+    for(int i = 1; i <= isize; i++){
+      const int cnt = isize * (j - 1) + (i - 1);
       const double ux_xm = UX(i  , j  );
       const double ux_xp = UX(i+1, j  );
       const double uy_ym = UY(i  , j  );
       const double uy_yp = UY(i  , j+1);
       rhs[cnt] = prefactor * (
-         + (ux_xp - ux_xm) / dx
-         + (uy_yp - uy_ym) / dy
+         + (ux_xp - ux_xm) * dxinv
+         + (uy_yp - uy_ym) * dyinv
       );
     }
   }
@@ -322,8 +395,10 @@ static int extract_output(
   const int isize = domain->mysizes[0];
   const int jsize = domain->mysizes[1];
   double * restrict psi = fluid->psi.data;
-  for(int cnt = 0, j = 1; j <= jsize; j++){
-    for(int i = 1; i <= isize; i++, cnt++){
+  THREADS_PRAGMA(omp parallel for schedule(static))
+  for(int j = 1; j <= jsize; j++){
+    for(int i = 1; i <= isize; i++){
+      const int cnt = isize * (j - 1) + (i - 1);
       PSI(i, j) = rhs[cnt];
     }
   }
@@ -332,31 +407,23 @@ static int extract_output(
 }
 
 static int solve_linear_systems(
-    poisson_solver_t * poisson_solver
+    poisson_solver_t * poisson_solver,
+    const size_t mbegin,
+    const size_t mend
 ){
-  // size of system (length) and how many such systems to be solved
+  // size of system (length) and range of the systems to be solved
   // NOTE: although size_of_system is the same as tdm.get_size gives,
-  //   repeat_for is different from what tdm.get_nrhs returns (=1)
-  //   here repeat_for is the degree of freedom in the wavespace
+  //   the range is different from what tdm.get_nrhs returns (=1)
+  //   here the range is a part of the degree of freedom in the wavespace
   const size_t size_of_system = poisson_solver->tdm_sizes[0];
-  const size_t repeat_for     = poisson_solver->tdm_sizes[1];
-  // tri-diagonal matrix
-  tdm_info_t * tdm_info = poisson_solver->tdm_info;
-  double * restrict tdm_l = NULL;
-  double * restrict tdm_u = NULL;
-  double * restrict tdm_c = NULL;
-  tdm.get_l(tdm_info, &tdm_l);
-  tdm.get_u(tdm_info, &tdm_u);
-  tdm.get_c(tdm_info, &tdm_c);
-  // eigenvalues coming from Fourier projection
-  const double * restrict evals = poisson_solver->evals;
+  // factorised matrices, one per wave number
+  tdm_factor_t * const * tdm_factors = poisson_solver->tdm_factors;
   double * restrict rhs = poisson_solver->buf0;
-  for(size_t m = 0; m < repeat_for; m++){
-    // set center diagonal components
-    for(size_t n = 0; n < size_of_system; n++){
-      tdm_c[n] = - tdm_l[n] - tdm_u[n] + evals[m];
-    }
-    tdm.solve(tdm_info, rhs + m * size_of_system);
+  const tdm_info_t * tdm_info = poisson_solver->tdm_info;
+  THREADS_PRAGMA(omp parallel for schedule(static))
+  for(size_t m = mbegin; m < mend; m++){
+    // matrix of this wave number, factorised in advance
+    tdm.solve_factorised(tdm_info, tdm_factors[m], rhs + m * size_of_system);
   }
   return 0;
 }
@@ -390,32 +457,37 @@ int fluid_compute_potential_dct(
   // assigned to buf0
   assign_input(domain, rkstep, dt, fluid, poisson_solver.buf0);
   // solve the equation
+  // NOTE: batch k is sent while batch k+1 is processed
+  const int nbatches = poisson_solver.nbatches;
   // project x to wave space
   // f(x, y)    -> f(k_x, y)
   // f(x, y, z) -> f(k_x, y, z)
   // from buf0 to buf1
-  fftw_execute(poisson_solver.fftw_plan_x[0]);
-  // transpose real x1pencil to y1pencil
+  // and transpose real x1pencil to y1pencil
   // from buf1 to buf0
-  sdecomp.transpose.execute(
-      poisson_solver.r_transposer_x1_to_y1,
-      poisson_solver.buf1,
-      poisson_solver.buf0
-  );
+  for(int k = 0; k < nbatches; k++){
+    if(NULL != poisson_solver.fftw_plan_x_forward[k]){
+      fftw_execute(poisson_solver.fftw_plan_x_forward[k]);
+    }
+    pipeline_start(poisson_solver.r_pipeline_x1_to_y1, k, poisson_solver.buf1);
+  }
+  pipeline_wait(poisson_solver.r_pipeline_x1_to_y1, poisson_solver.buf0);
   // solve linear systems
-  solve_linear_systems(&poisson_solver);
-  // transpose real y1pencil to x1pencil
+  // and transpose real y1pencil to x1pencil
   // from buf0 to buf1
-  sdecomp.transpose.execute(
-      poisson_solver.r_transposer_y1_to_x1,
-      poisson_solver.buf0,
-      poisson_solver.buf1
-  );
+  for(int k = 0; k < nbatches; k++){
+    size_t b = 0;
+    size_t e = 0;
+    pipeline_get_batch(poisson_solver.r_pipeline_y1_to_x1, k, &b, &e);
+    solve_linear_systems(&poisson_solver, b, e);
+    pipeline_start(poisson_solver.r_pipeline_y1_to_x1, k, poisson_solver.buf0);
+  }
+  pipeline_wait(poisson_solver.r_pipeline_y1_to_x1, poisson_solver.buf1);
   // project x to physical space
   // f(k_x, y)    -> f(x, y)
   // f(k_x, y, z) -> f(x, y, z)
   // from buf1 to buf0
-  fftw_execute(poisson_solver.fftw_plan_x[1]);
+  fftw_execute(poisson_solver.fftw_plan_x_backward);
   extract_output(domain, poisson_solver.buf0, fluid);
   return 0;
 }
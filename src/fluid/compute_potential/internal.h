@@ -0,0 +1,73 @@
+#if !defined(FLUID_COMPUTE_POTENTIAL_INTERNAL)
+#define FLUID_COMPUTE_POTENTIAL_INTERNAL
+
+#include <stdbool.h>
+#include "sdecomp.h"
+#include "domain.h"
+
+/**
+ * @struct wisdom_t
+ * @brief FFTW wisdom shared by the processes while the plans are created
+ * @var fname     : name of the file in which the wisdom is cached
+ * @var flags     : planning rigour (FFTW_ESTIMATE etc.) given by the user
+ * @var is_loaded : wisdom is imported from the file or not
+ * @var tic       : time when planning is started
+ */
+typedef struct {
+  char fname[256];
+  unsigned flags;
+  bool is_loaded;
+  double tic;
+} wisdom_t;
+
+extern int wisdom_begin(
+    const domain_t * domain,
+    const char kind[],
+    wisdom_t * wisdom
+);
+
+extern int wisdom_end(
+    const domain_t * domain,
+    wisdom_t * wisdom
+);
+
+/**
+ * @struct pipeline_t
+ * @brief transpose between the x1 and the y1 pencils,
+ *          which is split into batches sent by nonblocking all-to-alls
+ *          so that computations on the other batches can be overlapped
+ */
+typedef struct pipeline_t_ pipeline_t;
+
+extern int pipeline_construct(
+    const domain_t * domain,
+    const sdecomp_pencil_t pencil,
+    const size_t glsizes[NDIMS],
+    const size_t size_of_element,
+    pipeline_t ** pipeline
+);
+
+extern int pipeline_get_nbatches(
+    const pipeline_t * pipeline,
+    int * nbatches
+);
+
+extern int pipeline_get_batch(
+    const pipeline_t * pipeline,
+    const int batch,
+    size_t * begin,
+    size_t * end
+);
+
+extern int pipeline_start(
+    pipeline_t * pipeline,
+    const int batch,
+    const void * src
+);
+
+extern int pipeline_wait(
+    pipeline_t * pipeline,
+    void * dst
+);
+
+#endif // FLUID_COMPUTE_POTENTIAL_INTERNAL
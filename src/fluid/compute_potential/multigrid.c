@@ -0,0 +1,614 @@
+#include <stdio.h>
+#include <stdbool.h>
+#include <math.h>
+#include <mpi.h>
+#include "param.h"
+#include "sdecomp.h"
+#include "memory.h"
+#include "runge_kutta.h"
+#include "array.h"
+#include "domain.h"
+#include "halo.h"
+#include "fluid.h"
+#include "fluid_solver.h"
+#include "threads.h"
+#include "array_macros/domain/dxfinv.h"
+#include "array_macros/fluid/ux.h"
+#include "array_macros/fluid/uy.h"
+#include "array_macros/fluid/psi.h"
+
+// geometric multigrid solver of the Poisson equation,
+//   which communicates only with the neighbouring processes in y
+//   (and a few reductions to check the convergence
+//   and a gather of a coarse level)
+//   instead of the global transposes of the FFT-based solvers
+// cell-centred V-cycles:
+//   zebra x-line Gauss-Seidel smoother,
+//   full-weighting restriction and linear prolongation in y,
+//   coarse-grid operators re-discretised on the coarse faces
+// only y is coarsened (semi-coarsening),
+//   which, combined with the line smoother,
+//   converges regardless of the stretching of the x grid,
+//   and the x lines are solved without communication
+//   since the domain is decomposed only in y
+// y is coarsened as long as the local number of rows is even on all processes,
+//   after which the level is gathered on all processes
+//   to continue coarsening redundantly down to an odd number of rows,
+//   and the coarsest level is smoothed several times
+// the discrete operator is identical to the one of the FFT-based solvers,
+//   and the solution starts from the potential of the previous stage
+
+// number of pre- and post-smoothing sweeps
+static const int g_nsweeps = 2;
+// number of sweeps on the coarsest level
+static const int g_ncoarsest = 32;
+
+// maximum number of levels
+#define NLEVELSMAX 32
+
+// cell-centred array of a level, [0 : isize+1] x [0 : jsize+1]
+#define LVL(Q, I, J) (Q[(I) + (isize+2) * (J)])
+
+/**
+ * @struct level_t
+ * @brief grid and buffers of each level
+ * @var domain      : copy of the domain with the sizes of this level, used to exchange halos
+ * @var isize       : number of cells in x, which is common to all levels
+ * @var jsize       : local number of cells in y
+ * @var joffset     : offset of the local cells in y, to colour the rows
+ * @var is_gathered : the whole level is held by all processes
+ * @var counts      : number of elements of each process, to gather the level
+ * @var displs      : displacement of each process, to gather the level
+ * @var dxf         : cell widths in x
+ * @var cm, cp      : coefficients of the negative and positive x neighbours,
+ *                      which vanish on the walls (Neumann condition)
+ * @var cy          : coefficient of the y neighbours
+ * @var tdm_c       : upper diagonal of the x-line matrix after the forward elimination
+ * @var tdm_inv     : inverse of the diagonal of the x-line matrix after the forward elimination
+ * @var psi         : solution (or correction on coarse levels),
+ *                      which is the potential itself on the finest level
+ * @var rhs         : right-hand side
+ * @var res         : residual
+ * @var dtype       : halo datatype, shared by the arrays of this level
+ */
+typedef struct {
+  domain_t domain;
+  int isize;
+  int jsize;
+  int joffset;
+  bool is_gathered;
+  int * counts;
+  int * displs;
+  double * dxf;
+  double * cm;
+  double * cp;
+  double cy;
+  double * tdm_c;
+  double * tdm_inv;
+  array_t psi;
+  array_t rhs;
+  array_t res;
+  MPI_Datatype dtype;
+} level_t;
+
+typedef struct {
+  bool is_initialised;
+  int nlevels;
+  level_t * levels;
+  MPI_Comm comm;
+} multigrid_t;
+
+static int init_coefficients(
+    level_t * level
+){
+  const int isize = level->isize;
+  const double * restrict xf = level->domain.xf;
+  // cell centers, walls are included
+  double * xc = memory_calloc(isize + 2, sizeof(double));
+  xc[0] = xf[0];
+  for(int i = 1; i <= isize; i++){
+    xc[i] = 0.5 * (xf[i-1] + xf[i]);
+  }
+  xc[isize+1] = xf[isize];
+  level->dxf = memory_calloc(isize + 2, sizeof(double));
+  level->cm  = memory_calloc(isize + 2, sizeof(double));
+  level->cp  = memory_calloc(isize + 2, sizeof(double));
+  for(int i = 1; i <= isize; i++){
+    const double dxf = xf[i] - xf[i-1];
+    level->dxf[i] = dxf;
+    level->cm[i] = 1 == i     ? 0. : 1. / (xc[i  ] - xc[i-1]) / dxf;
+    level->cp[i] = isize == i ? 0. : 1. / (xc[i+1] - xc[i  ]) / dxf;
+  }
+  memory_free(xc);
+  // forward elimination of the x-line matrix,
+  //   which is shared by all rows of this level
+  const double * restrict cm = level->cm;
+  const double * restrict cp = level->cp;
+  const double cy = level->cy;
+  level->tdm_c   = memory_calloc(isize + 2, sizeof(double));
+  level->tdm_inv = memory_calloc(isize + 2, sizeof(double));
+  double * restrict tdm_c   = level->tdm_c;
+  double * restrict tdm_inv = level->tdm_inv;
+  for(int i = 1; i <= isize; i++){
+    const double diag = - cm[i] - cp[i] - 2. * cy;
+    tdm_inv[i] = 1. / (diag - cm[i] * tdm_c[i-1]);
+    tdm_c[i] = cp[i] * tdm_inv[i];
+  }
+  return 0;
+}
+
+static int init_level(
+    const int nadds[NDIMS][2],
+    const bool is_finest,
+    level_t * level
+){
+  const domain_t * domain = &level->domain;
+  level->isize = domain->mysizes[0];
+  level->jsize = domain->mysizes[1];
+  level->joffset = domain->offsets[1];
+  level->cy = 1. / domain->dy / domain->dy;
+  level->dtype = MPI_DOUBLE;
+  if(!is_finest){
+    if(0 != array.prepare(domain, nadds, sizeof(double), &level->psi)) return 1;
+  }
+  if(0 != array.prepare(domain, nadds, sizeof(double), &level->rhs)) return 1;
+  if(0 != array.prepare(domain, nadds, sizeof(double), &level->res)) return 1;
+  return init_coefficients(level);
+}
+
+// decide whether the given level can be coarsened,
+//   which should be agreed by all processes
+static bool check_coarsening(
+    const MPI_Comm comm,
+    const level_t * level
+){
+  int flag = 0 == level->jsize % 2 && 2 <= level->jsize;
+  MPI_Allreduce(MPI_IN_PLACE, &flag, 1, MPI_INT, MPI_LAND, comm);
+  return flag;
+}
+
+// copy of the given level, which is held by all processes,
+//   and the counts and the displacements to gather the rows
+static int init_gathered_level(
+    const MPI_Comm comm,
+    const int nprocs,
+    const level_t * fine,
+    level_t * coarse
+){
+  domain_t * cdomain = &coarse->domain;
+  *cdomain = fine->domain;
+  cdomain->mysizes[1] = cdomain->glsizes[1];
+  cdomain->offsets[1] = 0;
+  coarse->is_gathered = true;
+  if(0 != init_level(PSI_NADDS, false, coarse)) return 1;
+  // rows of each process, including the halo cells in x
+  const int isize = coarse->isize;
+  int * sizes = memory_calloc(2 * nprocs, sizeof(int));
+  MPI_Allgather((int [2]){fine->jsize, fine->joffset}, 2, MPI_INT, sizes, 2, MPI_INT, comm);
+  coarse->counts = memory_calloc(nprocs, sizeof(int));
+  coarse->displs = memory_calloc(nprocs, sizeof(int));
+  for(int n = 0; n < nprocs; n++){
+    coarse->counts[n] = (isize + 2) * sizes[2 * n + 0];
+    coarse->displs[n] = (isize + 2) * (sizes[2 * n + 1] + 1);
+  }
+  memory_free(sizes);
+  return 0;
+}
+
+static int init_multigrid(
+    const domain_t * domain,
+    multigrid_t * multigrid
+){
+  sdecomp.get_comm_cart(domain->info, &multigrid->comm);
+  int nprocs = 0;
+  MPI_Comm_size(multigrid->comm, &nprocs);
+  multigrid->levels = memory_calloc(NLEVELSMAX, sizeof(level_t));
+  level_t * levels = multigrid->levels;
+  // finest level, which is the domain itself
+  levels[0].domain = *domain;
+  if(0 != init_level(PSI_NADDS, true, levels + 0)) return 1;
+  int nlevels = 1;
+  for(; nlevels < NLEVELSMAX; nlevels++){
+    const level_t * fine = levels + nlevels - 1;
+    level_t * coarse = levels + nlevels;
+    if(!check_coarsening(multigrid->comm, fine)){
+      // gather the level, unless it has already been done
+      //   or it cannot be coarsened even then
+      if(fine->is_gathered || 1 == nprocs || 0 != fine->domain.glsizes[1] % 2){
+        break;
+      }
+      if(0 != init_gathered_level(multigrid->comm, nprocs, fine, coarse)) return 1;
+      continue;
+    }
+    // coarse faces are every other fine faces in y
+    domain_t * cdomain = &coarse->domain;
+    *cdomain = fine->domain;
+    cdomain->glsizes[1] /= 2;
+    cdomain->mysizes[1] /= 2;
+    cdomain->offsets[1] /= 2;
+    cdomain->dy *= 2.;
+    cdomain->dyinv /= 2.;
+    coarse->is_gathered = fine->is_gathered;
+    if(0 != init_level(PSI_NADDS, false, coarse)) return 1;
+  }
+  multigrid->nlevels = nlevels;
+  multigrid->is_initialised = true;
+  int myrank = 0;
+  sdecomp.get_comm_rank(domain->info, &myrank);
+  if(0 == myrank){
+    const level_t * coarsest = levels + nlevels - 1;
+    printf("multigrid solver is used\n");
+    printf("\tlevels: %d\n", nlevels);
+    for(int n = 1; n < nlevels; n++){
+      if(levels[n].is_gathered){
+        printf("\tgathered: %zu x %zu\n", levels[n].domain.glsizes[0], levels[n].domain.glsizes[1]);
+        break;
+      }
+    }
+    printf("\tcoarsest: %zu x %zu\n", coarsest->domain.glsizes[0], coarsest->domain.glsizes[1]);
+    fflush(stdout);
+  }
+  return 0;
+}
+
+// exchange halo cells in y of a cell-centred array of the given level,
+//   which is periodic in the process itself when the level is gathered
+static int exchange_halo(
+    level_t * level,
+    array_t * array
+){
+  if(!level->is_gathered){
+    return halo_communicate_in_y(&level->domain, &level->dtype, array);
+  }
+  const int isize = level->isize;
+  const int jsize = level->jsize;
+  double * restrict q = array->data;
+  for(int i = 0; i <= isize + 1; i++){
+    LVL(q, i,         0) = LVL(q, i, jsize);
+    LVL(q, i, jsize + 1) = LVL(q, i,     1);
+  }
+  return 0;
+}
+
+// zebra x-line Gauss-Seidel,
+//   rows whose global j has the given parity are solved exactly in x
+//   using the factorised matrix
+static int smooth(
+    level_t * level,
+    const int nsweeps
+){
+  const int isize = level->isize;
+  const int jsize = level->jsize;
+  const int joffset = level->joffset;
+  const double * restrict cm = level->cm;
+  const double cy = level->cy;
+  const double * restrict tdm_c   = level->tdm_c;
+  const double * restrict tdm_inv = level->tdm_inv;
+  const double * restrict rhs = level->rhs.data;
+  double * restrict psi = level->psi.data;
+  for(int sweep = 0; sweep < nsweeps; sweep++){
+    for(int colour = 0; colour < 2; colour++){
+      if(0 != exchange_halo(level, &level->psi)){
+        return 1;
+      }
+      // first row of this colour
+      const int js = 1 + (1 + joffset + colour) % 2;
+      THREADS_PRAGMA(omp parallel for schedule(static))
+      for(int j = js; j <= jsize; j += 2){
+        // forward elimination, the neighbouring rows are moved to the right-hand side
+        double val = 0.;
+        for(int i = 1; i <= isize; i++){
+          const double lrhs = LVL(rhs, i, j) - cy * (LVL(psi, i, j-1) + LVL(psi, i, j+1));
+          val = (lrhs - cm[i] * val) * tdm_inv[i];
+          LVL(psi, i, j) = val;
+        }
+        // backward substitution
+        for(int i = isize - 1; i >= 1; i--){
+          LVL(psi, i, j) -= tdm_c[i] * LVL(psi, i+1, j);
+        }
+      }
+    }
+  }
+  return 0;
+}
+
+// residual of the given level, whose maximum is returned
+static int compute_residual(
+    level_t * level,
+    double * resmax
+){
+  if(0 != exchange_halo(level, &level->psi)){
+    return 1;
+  }
+  const int isize = level->isize;
+  const int jsize = level->jsize;
+  const double * restrict cm = level->cm;
+  const double * restrict cp = level->cp;
+  const double cy = level->cy;
+  const double * restrict rhs = level->rhs.data;
+  const double * restrict psi = level->psi.data;
+  double * restrict res = level->res.data;
+  double lmax = 0.;
+  THREADS_PRAGMA(omp parallel for schedule(static) reduction(max: lmax))
+  for(int j = 1; j <= jsize; j++){
+    for(int i = 1; i <= isize; i++){
+      const double lap =
+        + cm[i] * (LVL(psi, i-1, j  ) - LVL(psi, i  , j  ))
+        + cp[i] * (LVL(psi, i+1, j  ) - LVL(psi, i  , j  ))
+        + cy    * (LVL(psi, i  , j-1) - LVL(psi, i  , j  ))
+        + cy    * (LVL(psi, i  , j+1) - LVL(psi, i  , j  ));
+      LVL(res, i, j) = LVL(rhs, i, j) - lap;
+      lmax = fmax(lmax, fabs(LVL(res, i, j)));
+    }
+  }
+  *resmax = lmax;
+  return 0;
+}
+
+// full weighting of the fine residual in y, (1, 3, 3, 1) / 8,
+//   which keeps the compatibility condition of the Neumann problem
+static int restrict_residual(
+    level_t * fine,
+    level_t * coarse
+){
+  if(0 != exchange_halo(fine, &fine->res)){
+    return 1;
+  }
+  const int isize = coarse->isize;
+  const int jsize = coarse->jsize;
+  const double * restrict res = fine->res.data;
+  double * restrict rhs = coarse->rhs.data;
+  double * restrict psi = coarse->psi.data;
+  THREADS_PRAGMA(omp parallel for schedule(static))
+  for(int j = 0; j <= jsize + 1; j++){
+    for(int i = 0; i <= isize + 1; i++){
+      LVL(psi, i, j) = 0.;
+    }
+  }
+  THREADS_PRAGMA(omp parallel for schedule(static))
+  for(int j = 1; j <= jsize; j++){
+    // children of this coarse row
+    const int jf = 2 * j;
+    for(int i = 1; i <= isize; i++){
+      LVL(rhs, i, j) = 0.125 * (
+          + 1. * LVL(res, i, jf - 2)
+          + 3. * LVL(res, i, jf - 1)
+          + 3. * LVL(res, i, jf    )
+          + 1. * LVL(res, i, jf + 1)
+      );
+    }
+  }
+  return 0;
+}
+
+// linear interpolation of the coarse correction in y
+static int prolong_correction(
+    level_t * coarse,
+    level_t * fine
+){
+  if(0 != exchange_halo(coarse, &coarse->psi)){
+    return 1;
+  }
+  const int isize = fine->isize;
+  const int jsize = fine->jsize;
+  const double * restrict cor = coarse->psi.data;
+  double * restrict psi = fine->psi.data;
+  THREADS_PRAGMA(omp parallel for schedule(static))
+  for(int j = 1; j <= jsize; j++){
+    // parent and neighbouring coarse rows
+    const int jc = (j + 1) / 2;
+    const int lc = 1 == j % 2 ? jc - 1 : jc + 1;
+    for(int i = 1; i <= isize; i++){
+      LVL(psi, i, j) += 0.75 * LVL(cor, i, jc) + 0.25 * LVL(cor, i, lc);
+    }
+  }
+  return 0;
+}
+
+// residual of all processes is collected to the gathered level
+static int gather_residual(
+    const MPI_Comm comm,
+    const level_t * fine,
+    level_t * coarse
+){
+  const int isize = coarse->isize;
+  const int jsize = coarse->jsize;
+  double * restrict psi = coarse->psi.data;
+  THREADS_PRAGMA(omp parallel for schedule(static))
+  for(int j = 0; j <= jsize + 1; j++){
+    for(int i = 0; i <= isize + 1; i++){
+      LVL(psi, i, j) = 0.;
+    }
+  }
+  const double * res = fine->res.data;
+  MPI_Allgatherv(
+      res + (isize + 2), (isize + 2) * fine->jsize, MPI_DOUBLE,
+      coarse->rhs.data, coarse->counts, coarse->displs, MPI_DOUBLE,
+      comm
+  );
+  return 0;
+}
+
+// correction of the local rows is picked up from the gathered level
+static int scatter_correction(
+    const level_t * coarse,
+    level_t * fine
+){
+  const int isize = fine->isize;
+  const int jsize = fine->jsize;
+  const int joffset = fine->joffset;
+  const double * restrict cor = coarse->psi.data;
+  double * restrict psi = fine->psi.data;
+  THREADS_PRAGMA(omp parallel for schedule(static))
+  for(int j = 1; j <= jsize; j++){
+    for(int i = 1; i <= isize; i++){
+      LVL(psi, i, j) += LVL(cor, i, j + joffset);
+    }
+  }
+  return 0;
+}
+
+static int vcycle(
+    multigrid_t * multigrid,
+    const int n
+){
+  level_t * level = multigrid->levels + n;
+  if(multigrid->nlevels - 1 == n){
+    return smooth(level, g_ncoarsest);
+  }
+  level_t * coarse = level + 1;
+  // the next level is the same grid held by all processes
+  const bool is_gathering = coarse->is_gathered && !level->is_gathered;
+  double resmax = 0.;
+  if(0 != smooth(level, g_nsweeps)) return 1;
+  if(0 != compute_residual(level, &resmax)) return 1;
+  if(is_gathering){
+    gather_residual(multigrid->comm, level, coarse);
+  }else{
+    if(0 != restrict_residual(level, coarse)) return 1;
+  }
+  if(0 != vcycle(multigrid, n + 1)) return 1;
+  if(is_gathering){
+    scatter_correction(coarse, level);
+  }else{
+    if(0 != prolong_correction(coarse, level)) return 1;
+  }
+  if(0 != smooth(level, g_nsweeps)) return 1;
+  return 0;
+}
+
+// volume-weighted mean of a cell-centred field on the finest level
+static double compute_mean(
+    const domain_t * domain,
+    const level_t * level,
+    const double * restrict q
+){
+  const int isize = level->isize;
+  const int jsize = level->jsize;
+  const double * restrict dxf = level->dxf;
+  double sum = 0.;
+  THREADS_PRAGMA(omp parallel for schedule(static) reduction(+: sum))
+  for(int j = 1; j <= jsize; j++){
+    for(int i = 1; i <= isize; i++){
+      sum += dxf[i] * LVL(q, i, j);
+    }
+  }
+  MPI_Comm comm_cart = MPI_COMM_NULL;
+  sdecomp.get_comm_cart(domain->info, &comm_cart);
+  MPI_Allreduce(MPI_IN_PLACE, &sum, 1, MPI_DOUBLE, MPI_SUM, comm_cart);
+  return sum / domain->lengths[0] / domain->glsizes[1];
+}
+
+static int assign_input(
+    const domain_t * domain,
+    const size_t rkstep,
+    const double dt,
+    const fluid_t * fluid,
+    level_t * level
+){
+  const int isize = domain->mysizes[0];
+  const int jsize = domain->mysizes[1];
+  const double * restrict dxfinv = domain->dxfinv;
+  const double dyinv = domain->dyinv;
+  const double * restrict ux = fluid->ux.data;
+  const double * restrict uy = fluid->uy.data;
+  double * restrict rhs = level->rhs.data;
+  const double prefactor = 1. / (rkcoefs[rkstep][rk_g] * dt);
+  THREADS_PRAGMA(omp parallel for schedule(static))
+  for(int j = 1; j <= jsize; j++){
+    for(int i = 1; i <= isize; i++){
+      const double ux_xm = UX(i  , j  );
+      const double ux_xp = UX(i+1, j  );
+      const double uy_ym = UY(i  , j  );
+      const double uy_yp = UY(i  , j+1);
+      LVL(rhs, i, j) = prefactor * (
+         + (ux_xp - ux_xm) * DXFINV(i  )
+         + (uy_yp - uy_ym) * dyinv
+      );
+    }
+  }
+  // remove the mean, which is not zero due to round-off errors
+  //   and otherwise prevents the singular system from converging
+  const double mean = compute_mean(domain, level, rhs);
+  THREADS_PRAGMA(omp parallel for schedule(static))
+  for(int j = 1; j <= jsize; j++){
+    for(int i = 1; i <= isize; i++){
+      LVL(rhs, i, j) -= mean;
+    }
+  }
+  return 0;
+}
+
+/**
+ * @brief compute scalar potential psi to correct velocity
+ * @param[in]     domain : information about domain decomposition and size
+ * @param[in]     rkstep : Runge-Kutta step
+ * @param[in]     dt     : time step size
+ * @param[in,out] fluid  : velocity (in), scalar potential psi (in: initial guess, out)
+ * @return               : (success) 0
+ *                       : (failure) 1
+ */
+int fluid_compute_potential_mg(
+    const domain_t * domain,
+    const size_t rkstep,
+    const double dt,
+    fluid_t * fluid
+){
+  static multigrid_t multigrid = {
+    .is_initialised = false,
+  };
+  if(!multigrid.is_initialised){
+    if(0 != init_multigrid(domain, &multigrid)){
+      return 1;
+    }
+  }
+  level_t * finest = multigrid.levels;
+  // the potential of the previous stage is the initial guess
+  finest->psi = fluid->psi;
+  assign_input(domain, rkstep, dt, fluid, finest);
+  // tolerance relative to the right-hand side
+  const int isize = domain->mysizes[0];
+  const int jsize = domain->mysizes[1];
+  const double * restrict rhs = finest->rhs.data;
+  double rhsmax = 0.;
+  THREADS_PRAGMA(omp parallel for schedule(static) reduction(max: rhsmax))
+  for(int j = 1; j <= jsize; j++){
+    for(int i = 1; i <= isize; i++){
+      rhsmax = fmax(rhsmax, fabs(LVL(rhs, i, j)));
+    }
+  }
+  MPI_Allreduce(MPI_IN_PLACE, &rhsmax, 1, MPI_DOUBLE, MPI_MAX, multigrid.comm);
+  const double tolerance = param_poisson_mg_tolerance * rhsmax;
+  double resmax = 0.;
+  int ncycles = 0;
+  for(;;){
+    if(0 != compute_residual(finest, &resmax)) return 1;
+    MPI_Allreduce(MPI_IN_PLACE, &resmax, 1, MPI_DOUBLE, MPI_MAX, multigrid.comm);
+    if(resmax <= tolerance || param_poisson_mg_maxcycles <= ncycles){
+      break;
+    }
+    if(0 != vcycle(&multigrid, 0)) return 1;
+    ncycles += 1;
+  }
+  if(resmax > tolerance){
+    // not fatal, the divergence is left larger than expected
+    int myrank = 0;
+    sdecomp.get_comm_rank(domain->info, &myrank);
+    if(0 == myrank){
+      printf("multigrid not converged after %d cycles: % .1e (tolerance % .1e)\n", ncycles, resmax, tolerance);
+      fflush(stdout);
+    }
+  }
+  // fix the undetermined constant
+  double * restrict psi = fluid->psi.data;
+  const double mean = compute_mean(domain, finest, psi);
+  THREADS_PRAGMA(omp parallel for schedule(static))
+  for(int j = 1; j <= jsize; j++){
+    for(int i = 1; i <= isize; i++){
+      PSI(i, j) -= mean;
+    }
+  }
+  fluid_update_boundaries_psi(domain, &fluid->psi);
+  return 0;
+}
+
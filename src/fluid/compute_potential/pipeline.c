@@ -0,0 +1,428 @@
+#include <stdio.h>
+#include <string.h>
+#include <mpi.h>
+#include "param.h"
+#include "sdecomp.h"
+#include "memory.h"
+#include "domain.h"
+#include "threads.h"
+#include "internal.h"
+
+// number of elements in each direction of the blocks
+//   transposed at once by a single process
+#define BLOCKSIZE 16
+
+// pencil transposes of the Poisson solvers, split into batches
+// the source pencil is split along its distributed direction ("outer"),
+//   e.g. rows of an x1 pencil, and each batch is sent
+//   by a nonblocking all-to-all as soon as it is ready,
+//   so that the transforms and the tri-diagonal solves of the next batch
+//   overlap with the communication
+// batch "k" of each process covers its local outer indices
+//   [n * k / nbatches : n * (k + 1) / nbatches),
+//   which is known to the others as well
+// the source pencil is contiguous in the other direction ("inner"),
+//   whereas the destination pencil is contiguous in the outer direction:
+//   x1 to y1: outer is y and inner is x
+//   y1 to x1: outer is x and inner is y
+// NOTE: if only one batch is used,
+//   the transpose of the pencil decomposition library is used as it is
+// NOTE: when a single process is launched,
+//   the pencil is transposed locally block by block without MPI
+
+struct pipeline_t_ {
+  int nbatches;
+  size_t size_of_element;
+  // global lengths of the inner and outer directions
+  size_t gl_inner;
+  size_t gl_outer;
+  // local sizes and offsets of all processes,
+  //   outer direction of the source pencils
+  //   and inner direction of the destination pencils
+  int nprocs;
+  int myrank;
+  int * outer_sizes;
+  int * outer_offsets;
+  int * inner_sizes;
+  int * inner_offsets;
+  // message buffers, whose layouts are
+  //   [my outer][global inner] and [global outer][my inner], respectively
+  char * restrict sendbuf;
+  char * restrict recvbuf;
+  // message sizes and displacements of each batch, in elements
+  int * sendcounts;
+  int * senddispls;
+  int * recvcounts;
+  int * recvdispls;
+  MPI_Datatype dtype;
+  MPI_Comm comm;
+  MPI_Request * requests;
+  bool * is_completed;
+  int nstarted;
+  // used instead when only one batch is used
+  bool is_local;
+  sdecomp_transpose_plan_t * transposer;
+  const void * src;
+};
+
+static void get_range(
+    const int size,
+    const int nbatches,
+    const int batch,
+    int * begin,
+    int * end
+){
+  *begin = size *  batch      / nbatches;
+  *end   = size * (batch + 1) / nbatches;
+}
+
+static int init_sizes(
+    const sdecomp_info_t * info,
+    const sdecomp_pencil_t pencil,
+    const size_t glsizes[NDIMS],
+    pipeline_t * pipeline
+){
+  // x1 to y1: rows (y) of x1 are sent, columns (x) of y1 are received
+  // y1 to x1: columns (x) of y1 are sent, rows (y) of x1 are received
+  const bool is_x1_to_y1 = SDECOMP_X1PENCIL == pencil;
+  const sdecomp_pencil_t dest = is_x1_to_y1 ? SDECOMP_Y1PENCIL : SDECOMP_X1PENCIL;
+  const sdecomp_dir_t dir_outer = is_x1_to_y1 ? SDECOMP_YDIR : SDECOMP_XDIR;
+  const sdecomp_dir_t dir_inner = is_x1_to_y1 ? SDECOMP_XDIR : SDECOMP_YDIR;
+  pipeline->gl_outer = glsizes[dir_outer];
+  pipeline->gl_inner = glsizes[dir_inner];
+  size_t sizes[2] = {0};
+  size_t offsets[2] = {0};
+  if(0 != sdecomp.get_pencil_mysize(info, pencil, dir_outer, glsizes[dir_outer], sizes   + 0)) return 1;
+  if(0 != sdecomp.get_pencil_offset(info, pencil, dir_outer, glsizes[dir_outer], offsets + 0)) return 1;
+  if(0 != sdecomp.get_pencil_mysize(info, dest,   dir_inner, glsizes[dir_inner], sizes   + 1)) return 1;
+  if(0 != sdecomp.get_pencil_offset(info, dest,   dir_inner, glsizes[dir_inner], offsets + 1)) return 1;
+  // share them with the others
+  const int nprocs = pipeline->nprocs;
+  const int mine[4] = {
+    (int)sizes[0], (int)offsets[0],
+    (int)sizes[1], (int)offsets[1],
+  };
+  int * all = memory_calloc(4 * nprocs, sizeof(int));
+  MPI_Allgather(mine, 4, MPI_INT, all, 4, MPI_INT, pipeline->comm);
+  pipeline->outer_sizes   = memory_calloc(nprocs, sizeof(int));
+  pipeline->outer_offsets = memory_calloc(nprocs, sizeof(int));
+  pipeline->inner_sizes   = memory_calloc(nprocs, sizeof(int));
+  pipeline->inner_offsets = memory_calloc(nprocs, sizeof(int));
+  for(int n = 0; n < nprocs; n++){
+    pipeline->outer_sizes  [n] = all[4 * n + 0];
+    pipeline->outer_offsets[n] = all[4 * n + 1];
+    pipeline->inner_sizes  [n] = all[4 * n + 2];
+    pipeline->inner_offsets[n] = all[4 * n + 3];
+  }
+  memory_free(all);
+  return 0;
+}
+
+static int init_messages(
+    pipeline_t * pipeline
+){
+  const int nbatches = pipeline->nbatches;
+  const int nprocs = pipeline->nprocs;
+  const int myrank = pipeline->myrank;
+  const int gl_inner = (int)pipeline->gl_inner;
+  const int * outer_sizes   = pipeline->outer_sizes;
+  const int * outer_offsets = pipeline->outer_offsets;
+  const int * inner_sizes   = pipeline->inner_sizes;
+  const int * inner_offsets = pipeline->inner_offsets;
+  pipeline->sendcounts = memory_calloc(nbatches * nprocs, sizeof(int));
+  pipeline->senddispls = memory_calloc(nbatches * nprocs, sizeof(int));
+  pipeline->recvcounts = memory_calloc(nbatches * nprocs, sizeof(int));
+  pipeline->recvdispls = memory_calloc(nbatches * nprocs, sizeof(int));
+  for(int k = 0; k < nbatches; k++){
+    for(int n = 0; n < nprocs; n++){
+      // my outer indices in this batch, to the inner indices of process n
+      int b = 0;
+      int e = 0;
+      get_range(outer_sizes[myrank], nbatches, k, &b, &e);
+      pipeline->sendcounts[k * nprocs + n] = (e - b) * inner_sizes[n];
+      pipeline->senddispls[k * nprocs + n] = b * gl_inner + (e - b) * inner_offsets[n];
+      // outer indices of process n in this batch, to my inner indices
+      get_range(outer_sizes[n], nbatches, k, &b, &e);
+      pipeline->recvcounts[k * nprocs + n] = (e - b) * inner_sizes[myrank];
+      pipeline->recvdispls[k * nprocs + n] = (outer_offsets[n] + b) * inner_sizes[myrank];
+    }
+  }
+  const size_t size_of_element = pipeline->size_of_element;
+  const size_t nitems_send = (size_t)outer_sizes[myrank] * pipeline->gl_inner;
+  const size_t nitems_recv = (size_t)inner_sizes[myrank] * pipeline->gl_outer;
+  pipeline->sendbuf = memory_calloc(nitems_send < 1 ? 1 : nitems_send, size_of_element);
+  pipeline->recvbuf = memory_calloc(nitems_recv < 1 ? 1 : nitems_recv, size_of_element);
+  MPI_Type_contiguous((int)size_of_element, MPI_BYTE, &pipeline->dtype);
+  MPI_Type_commit(&pipeline->dtype);
+  pipeline->requests = memory_calloc(nbatches, sizeof(MPI_Request));
+  pipeline->is_completed = memory_calloc(nbatches, sizeof(bool));
+  for(int k = 0; k < nbatches; k++){
+    pipeline->requests[k] = MPI_REQUEST_NULL;
+    pipeline->is_completed[k] = false;
+  }
+  pipeline->nstarted = 0;
+  return 0;
+}
+
+/**
+ * @brief construct a batched transpose from the x1 to the y1 pencil or vice versa
+ * @param[in]  domain          : information about domain decomposition and size
+ * @param[in]  pencil          : source pencil, SDECOMP_X1PENCIL or SDECOMP_Y1PENCIL
+ * @param[in]  glsizes         : global array size
+ * @param[in]  size_of_element : size of each element in bytes
+ * @param[out] pipeline        : batched transpose
+ * @return                     : error code
+ */
+int pipeline_construct(
+    const domain_t * domain,
+    const sdecomp_pencil_t pencil,
+    const size_t glsizes[NDIMS],
+    const size_t size_of_element,
+    pipeline_t ** pipeline
+){
+  if(SDECOMP_X1PENCIL != pencil && SDECOMP_Y1PENCIL != pencil){
+    printf("pipeline, unknown source pencil: %d\n", (int)pencil);
+    return 1;
+  }
+  const sdecomp_info_t * info = domain->info;
+  *pipeline = memory_calloc(1, sizeof(pipeline_t));
+  pipeline_t * p = *pipeline;
+  p->size_of_element = size_of_element;
+  sdecomp.get_comm_cart(info, &p->comm);
+  sdecomp.get_comm_size(info, &p->nprocs);
+  sdecomp.get_comm_rank(info, &p->myrank);
+  // nothing to overlap with if there is no communication
+  p->nbatches = 1 == p->nprocs ? 1 : param_poisson_nbatches;
+  if(p->nbatches < 1){
+    printf("param_poisson_nbatches should be positive: %d\n", p->nbatches);
+    return 1;
+  }
+  if(0 != init_sizes(info, pencil, glsizes, p)) return 1;
+  p->is_local = 1 == p->nprocs;
+  if(p->is_local){
+    // transposed as an array of doubles
+    if(0 != size_of_element % sizeof(double)){
+      printf("pipeline, element size should be a multiple of double: %zu\n", size_of_element);
+      return 1;
+    }
+    return 0;
+  }
+  if(1 == p->nbatches){
+    const sdecomp_pencil_t dest = SDECOMP_X1PENCIL == pencil ? SDECOMP_Y1PENCIL : SDECOMP_X1PENCIL;
+    return sdecomp.transpose.construct(info, pencil, dest, glsizes, size_of_element, &p->transposer);
+  }
+  return init_messages(p);
+}
+
+/**
+ * @brief get the number of batches
+ * @param[in]  pipeline : batched transpose
+ * @param[out] nbatches : number of batches
+ * @return              : error code
+ */
+int pipeline_get_nbatches(
+    const pipeline_t * pipeline,
+    int * nbatches
+){
+  *nbatches = pipeline->nbatches;
+  return 0;
+}
+
+/**
+ * @brief get local outer indices of the source pencil in a batch,
+ *          i.e., rows of the x1 pencil or columns of the y1 pencil
+ * @param[in]  pipeline : batched transpose
+ * @param[in]  batch    : index of the batch
+ * @param[out] begin    : first index
+ * @param[out] end      : last index plus one
+ * @return              : error code
+ */
+int pipeline_get_batch(
+    const pipeline_t * pipeline,
+    const int batch,
+    size_t * begin,
+    size_t * end
+){
+  int b = 0;
+  int e = 0;
+  get_range(pipeline->outer_sizes[pipeline->myrank], pipeline->nbatches, batch, &b, &e);
+  *begin = b;
+  *end   = e;
+  return 0;
+}
+
+// give MPI a chance to progress the batches in flight,
+//   which are unpacked later in pipeline_wait
+static int progress(
+    pipeline_t * pipeline
+){
+  for(int k = 0; k < pipeline->nstarted; k++){
+    if(pipeline->is_completed[k]){
+      continue;
+    }
+    int flag = 0;
+    MPI_Test(pipeline->requests + k, &flag, MPI_STATUS_IGNORE);
+    pipeline->is_completed[k] = 0 != flag;
+  }
+  return 0;
+}
+
+/**
+ * @brief send a batch of the source pencil, which should be ready
+ * @param[in,out] pipeline : batched transpose
+ * @param[in]     batch    : index of the batch, started in ascending order
+ * @param[in]     src      : source pencil,
+ *                             only the batch is accessed and can be re-used afterwards
+ * @return                 : error code
+ */
+int pipeline_start(
+    pipeline_t * pipeline,
+    const int batch,
+    const void * src
+){
+  if(1 == pipeline->nbatches){
+    // transposed as a whole in pipeline_wait
+    pipeline->src = src;
+    return 0;
+  }
+  progress(pipeline);
+  const size_t size_of_element = pipeline->size_of_element;
+  const size_t gl_inner = pipeline->gl_inner;
+  const int nprocs = pipeline->nprocs;
+  const int * inner_sizes   = pipeline->inner_sizes;
+  const int * inner_offsets = pipeline->inner_offsets;
+  const int * sendcounts = pipeline->sendcounts + batch * nprocs;
+  const int * senddispls = pipeline->senddispls + batch * nprocs;
+  const int * recvcounts = pipeline->recvcounts + batch * nprocs;
+  const int * recvdispls = pipeline->recvdispls + batch * nprocs;
+  size_t b = 0;
+  size_t e = 0;
+  pipeline_get_batch(pipeline, batch, &b, &e);
+  // pack, inner indices of each process are contiguous in the source
+  const char * restrict s = src;
+  char * restrict sendbuf = pipeline->sendbuf;
+  THREADS_PRAGMA(omp parallel for schedule(static))
+  for(size_t o = b; o < e; o++){
+    for(int n = 0; n < nprocs; n++){
+      const size_t ninners = inner_sizes[n];
+      memcpy(
+          sendbuf + size_of_element * (senddispls[n] + (o - b) * ninners),
+          s + size_of_element * (o * gl_inner + inner_offsets[n]),
+          size_of_element * ninners
+      );
+    }
+  }
+  MPI_Ialltoallv(
+      pipeline->sendbuf, sendcounts, senddispls, pipeline->dtype,
+      pipeline->recvbuf, recvcounts, recvdispls, pipeline->dtype,
+      pipeline->comm,
+      pipeline->requests + batch
+  );
+  pipeline->is_completed[batch] = false;
+  pipeline->nstarted = batch + 1;
+  return 0;
+}
+
+static int unpack(
+    const pipeline_t * pipeline,
+    const int batch,
+    void * dst
+){
+  const size_t size_of_element = pipeline->size_of_element;
+  const size_t gl_outer = pipeline->gl_outer;
+  const int nbatches = pipeline->nbatches;
+  const int nprocs = pipeline->nprocs;
+  const int ninners = pipeline->inner_sizes[pipeline->myrank];
+  const int * outer_sizes   = pipeline->outer_sizes;
+  const int * outer_offsets = pipeline->outer_offsets;
+  const char * restrict recvbuf = pipeline->recvbuf;
+  char * restrict d = dst;
+  // global outer indices of this batch are transposed,
+  //   so that they are contiguous in the destination
+  THREADS_PRAGMA(omp parallel for schedule(static))
+  for(int i = 0; i < ninners; i++){
+    for(int n = 0; n < nprocs; n++){
+      int b = 0;
+      int e = 0;
+      get_range(outer_sizes[n], nbatches, batch, &b, &e);
+      for(size_t o = outer_offsets[n] + b; o < (size_t)(outer_offsets[n] + e); o++){
+        memcpy(
+            d + size_of_element * (i * gl_outer + o),
+            recvbuf + size_of_element * (o * ninners + i),
+            size_of_element
+        );
+      }
+    }
+  }
+  return 0;
+}
+
+// transpose the whole pencil by a single process,
+//   [outer][inner] to [inner][outer],
+//   block by block so that both of them are accessed in cache
+static int transpose_local(
+    const pipeline_t * pipeline,
+    const void * src,
+    void * dst
+){
+  const size_t ncomps = pipeline->size_of_element / sizeof(double);
+  const size_t gl_outer = pipeline->gl_outer;
+  const size_t gl_inner = pipeline->gl_inner;
+  const double * restrict s = src;
+  double * restrict d = dst;
+  THREADS_PRAGMA(omp parallel for schedule(static))
+  for(size_t ib = 0; ib < gl_inner; ib += BLOCKSIZE){
+    const size_t ie = ib + BLOCKSIZE < gl_inner ? ib + BLOCKSIZE : gl_inner;
+    for(size_t ob = 0; ob < gl_outer; ob += BLOCKSIZE){
+      const size_t oe = ob + BLOCKSIZE < gl_outer ? ob + BLOCKSIZE : gl_outer;
+      for(size_t i = ib; i < ie; i++){
+        for(size_t o = ob; o < oe; o++){
+          for(size_t c = 0; c < ncomps; c++){
+            d[ncomps * (i * gl_outer + o) + c] = s[ncomps * (o * gl_inner + i) + c];
+          }
+        }
+      }
+    }
+  }
+  return 0;
+}
+
+/**
+ * @brief wait for all batches and store them to the destination pencil
+ * @param[in,out] pipeline : batched transpose
+ * @param[out]    dst      : destination pencil
+ * @return                 : error code
+ */
+int pipeline_wait(
+    pipeline_t * pipeline,
+    void * dst
+){
+  if(pipeline->is_local){
+    return transpose_local(pipeline, pipeline->src, dst);
+  }
+  if(1 == pipeline->nbatches){
+    return sdecomp.transpose.execute(pipeline->transposer, pipeline->src, dst);
+  }
+  if(pipeline->nbatches != pipeline->nstarted){
+    printf("pipeline, %d batches out of %d are started\n", pipeline->nstarted, pipeline->nbatches);
+    return 1;
+  }
+  // batches which are already delivered
+  for(int k = 0; k < pipeline->nbatches; k++){
+    if(pipeline->is_completed[k]){
+      unpack(pipeline, k, dst);
+    }
+  }
+  // the others, in the order of arrival
+  while(true){
+    int k = MPI_UNDEFINED;
+    MPI_Waitany(pipeline->nbatches, pipeline->requests, &k, MPI_STATUS_IGNORE);
+    if(MPI_UNDEFINED == k){
+      break;
+    }
+    unpack(pipeline, k, dst);
+  }
+  pipeline->nstarted = 0;
+  return 0;
+}
+
@@ -0,0 +1,191 @@
+#include <stdio.h>
+#include <string.h>
+#include <mpi.h>
+#include <fftw3.h>
+#include "sdecomp.h"
+#include "memory.h"
+#include "config.h"
+#include "timer.h"
+#include "threads.h"
+#include "domain.h"
+#include "internal.h"
+
+// planning FFTW with high rigour takes long for large domains,
+//   which is repeated on every launch unless the result is cached
+// the wisdom is cached in a file whose name tells
+//   the transform, the global size, and the layout of processes and threads,
+//   so that a run with a different configuration does not pick it up
+// only the main process accesses the file:
+//   the wisdom is broadcast to the others before planning,
+//   and the wisdom of all processes, whose local sizes may differ,
+//   is gathered to the main process after planning
+
+static const char g_fname_prefix[] = {"output/fftw_wisdom"};
+
+// planning rigour, selected by the user
+static const struct {
+  const char * name;
+  unsigned flag;
+} g_rigours[] = {
+  {"estimate",   FFTW_ESTIMATE  },
+  {"measure",    FFTW_MEASURE   },
+  {"patient",    FFTW_PATIENT   },
+  {"exhaustive", FFTW_EXHAUSTIVE},
+};
+
+static const int g_nrigours = sizeof(g_rigours) / sizeof(g_rigours[0]);
+
+static int g_rigour = 0;
+
+static int load_rigour(
+    void
+){
+  double value = 0.;
+  if(0 != config.get_double("fftw_rigour", &value)){
+    return 1;
+  }
+  g_rigour = (int)value;
+  if(g_rigour < 0 || g_nrigours <= g_rigour){
+    printf("fftw_rigour should be in [0 : %d]: %d\n", g_nrigours - 1, g_rigour);
+    return 1;
+  }
+  return 0;
+}
+
+/**
+ * @brief decide planning rigour and import cached wisdom, if any
+ * @param[in]  domain : information about domain decomposition and size
+ * @param[in]  kind   : name of the transforms
+ * @param[out] wisdom : file name, planning rigour, and timer
+ * @return            : error code
+ */
+int wisdom_begin(
+    const domain_t * domain,
+    const char kind[],
+    wisdom_t * wisdom
+){
+  if(0 != load_rigour()){
+    return 1;
+  }
+  wisdom->flags = g_rigours[g_rigour].flag;
+  const sdecomp_info_t * info = domain->info;
+  const int root = 0;
+  int myrank = root;
+  int nprocs = 1;
+  MPI_Comm comm_cart = MPI_COMM_NULL;
+  sdecomp.get_comm_rank(info, &myrank);
+  sdecomp.get_comm_size(info, &nprocs);
+  sdecomp.get_comm_cart(info, &comm_cart);
+  const int nchars = snprintf(
+      wisdom->fname, sizeof(wisdom->fname),
+      "%s_%s_%zux%zu_%dprocs_%dthreads.dat",
+      g_fname_prefix,
+      kind,
+      domain->glsizes[0],
+      domain->glsizes[1],
+      nprocs,
+      threads_get_nthreads()
+  );
+  if(nchars < 0 || sizeof(wisdom->fname) <= (size_t)nchars){
+    if(root == myrank){
+      printf("FFTW wisdom, file name is too long\n");
+    }
+    return 1;
+  }
+  // load on the main process and share it
+  int length = 0;
+  char * string = NULL;
+  if(root == myrank){
+    if(1 == fftw_import_wisdom_from_filename(wisdom->fname)){
+      string = fftw_export_wisdom_to_string();
+      length = NULL == string ? 0 : (int)strlen(string) + 1;
+    }
+  }
+  MPI_Bcast(&length, 1, MPI_INT, root, comm_cart);
+  wisdom->is_loaded = 0 < length;
+  if(wisdom->is_loaded){
+    if(root == myrank){
+      MPI_Bcast(string, length, MPI_CHAR, root, comm_cart);
+      fftw_free(string);
+    }else{
+      string = memory_calloc(length, sizeof(char));
+      MPI_Bcast(string, length, MPI_CHAR, root, comm_cart);
+      fftw_import_wisdom_from_string(string);
+      memory_free(string);
+    }
+  }
+  wisdom->tic = timer();
+  return 0;
+}
+
+/**
+ * @brief export wisdom accumulated by all processes and report planning time
+ * @param[in] domain : information about domain decomposition and size
+ * @param[in] wisdom : file name, planning rigour, and timer
+ * @return           : error code
+ */
+int wisdom_end(
+    const domain_t * domain,
+    wisdom_t * wisdom
+){
+  const double toc = timer();
+  const sdecomp_info_t * info = domain->info;
+  const int root = 0;
+  int myrank = root;
+  int nprocs = 1;
+  MPI_Comm comm_cart = MPI_COMM_NULL;
+  sdecomp.get_comm_rank(info, &myrank);
+  sdecomp.get_comm_size(info, &nprocs);
+  sdecomp.get_comm_cart(info, &comm_cart);
+  // estimate does not measure anything and thus has nothing to cache
+  const bool is_cached = FFTW_ESTIMATE != wisdom->flags;
+  if(is_cached){
+    // gather wisdom of all processes to the main process
+    char * string = fftw_export_wisdom_to_string();
+    int length = NULL == string ? 0 : (int)strlen(string) + 1;
+    int * lengths = NULL;
+    int * displs = NULL;
+    char * strings = NULL;
+    if(root == myrank){
+      lengths = memory_calloc(nprocs, sizeof(int));
+      displs  = memory_calloc(nprocs, sizeof(int));
+    }
+    MPI_Gather(&length, 1, MPI_INT, lengths, 1, MPI_INT, root, comm_cart);
+    if(root == myrank){
+      int total = 0;
+      for(int n = 0; n < nprocs; n++){
+        displs[n] = total;
+        total += lengths[n];
+      }
+      strings = memory_calloc(total < 1 ? 1 : total, sizeof(char));
+    }
+    MPI_Gatherv(string, length, MPI_CHAR, strings, lengths, displs, MPI_CHAR, root, comm_cart);
+    if(NULL != string){
+      fftw_free(string);
+    }
+    if(root == myrank){
+      // the main process already knows its own wisdom
+      for(int n = 1; n < nprocs; n++){
+        if(0 < lengths[n]){
+          fftw_import_wisdom_from_string(strings + displs[n]);
+        }
+      }
+      if(1 != fftw_export_wisdom_to_filename(wisdom->fname)){
+        // not fatal, planning is repeated next time
+        printf("FFTW wisdom, failed to export: %s\n", wisdom->fname);
+      }
+      memory_free(lengths);
+      memory_free(displs);
+      memory_free(strings);
+    }
+  }
+  if(root == myrank){
+    printf("FFTW\n");
+    printf("\trigour: %s\n", g_rigours[g_rigour].name);
+    printf("\twisdom: %s (%s)\n", wisdom->fname, wisdom->is_loaded ? "loaded" : "not found");
+    printf("\tplanning time: % .3e [sec]\n", toc - wisdom->tic);
+    fflush(stdout);
+  }
+  return 0;
+}
+
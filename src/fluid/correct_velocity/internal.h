@@ -4,12 +4,16 @@
 extern int fluid_correct_velocity_ux(
     const domain_t * domain,
     const double prefactor,
+    const int is,
+    const int ie,
     fluid_t * fluid
 );
 
 extern int fluid_correct_velocity_uy(
     const domain_t * domain,
     const double prefactor,
+    const int is,
+    const int ie,
     fluid_t * fluid
 );
 
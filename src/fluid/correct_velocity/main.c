@@ -1,4 +1,5 @@
 #include "runge_kutta.h"
+#include "tiling.h"
 #include "domain.h"
 #include "fluid.h"
 #include "fluid_solver.h"
@@ -21,8 +22,25 @@ int fluid_correct_velocity(
   // compute prefactor gamma dt
   const double gamma = rkcoefs[rkstep][rk_g];
   const double prefactor = gamma * dt;
-  fluid_correct_velocity_ux(domain, prefactor, fluid);
-  fluid_correct_velocity_uy(domain, prefactor, fluid);
+  static tiling_t tiling = {
+    .name = "fluid_correct_velocity",
+    .is_initialised = false,
+  };
+  const int isize = domain->mysizes[0];
+  int size = isize;
+  if(0 != tiling_begin(domain, &tiling, &size)){
+    return 1;
+  }
+  // both components are corrected tile by tile
+  for(int is = 1; is <= isize; is += size){
+    const int ie = is + size - 1 < isize ? is + size - 1 : isize;
+    fluid_correct_velocity_ux(domain, prefactor, is, ie, fluid);
+    fluid_correct_velocity_uy(domain, prefactor, is, ie, fluid);
+  }
+  tiling_end(domain, &tiling);
+  // update boundary and halo cells
+  fluid_update_boundaries_ux(domain, &fluid->ux);
+  fluid_update_boundaries_uy(domain, &fluid->uy);
   return 0;
 }
 
@@ -1,42 +1,68 @@
+#include <stdbool.h>
 #include "domain.h"
 #include "fluid.h"
 #include "fluid_solver.h"
+#include "threads.h"
 #include "internal.h"
-#include "array_macros/domain/dxc.h"
+#include "array_macros/domain/dxcinv.h"
 #include "array_macros/fluid/ux.h"
 #include "array_macros/fluid/psi.h"
 
-/**
- * @brief correct ux using scalar potential psi
- * @param[in]     domain    : information about domain decomposition and size
- * @param[in]     prefactor : pre-factor in front of grad psi
- * @param[in,out] fluid     : scalar potential psi (in), ux (out)
- * @return                  : error code
- */
-int fluid_correct_velocity_ux(
+// specialised for uniform x grids by giving a constant "is_uniform"
+static inline int kernel(
     const domain_t * domain,
+    const bool is_uniform,
     const double prefactor,
+    const int is,
+    const int ie,
     fluid_t * fluid
 ){
   const int isize = domain->mysizes[0];
   const int jsize = domain->mysizes[1];
-  const double * restrict dxc = domain->dxc;
+  const double * restrict dxcinv = domain->dxcinv;
+  // constant metric of uniform grids
+  const double dxinv = domain->dxfinv[0];
   const double * restrict psi = fluid->psi.data;
   double * restrict ux = fluid->ux.data;
+  // x faces in the tile, the left-most wall face is excluded
+  THREADS_PRAGMA(omp parallel for schedule(static))
   for(int j = 1; j <= jsize; j++){
-    for(int i = 2; i <= isize; i++){
+    for(int i = 2 < is ? is : 2; i <= ie; i++){
       // correct x velocity
-      const double dx = DXC(i  );
+      const double lxinv = is_uniform ? dxinv : DXCINV(i  );
       const double psi_xm = PSI(i-1, j  );
       const double psi_xp = PSI(i  , j  );
-      UX(i, j) -= prefactor / dx * (
+      UX(i, j) -= prefactor * lxinv * (
           + psi_xp
           - psi_xm
       );
     }
   }
-  // update boundary and halo cells
-  fluid_update_boundaries_ux(domain, &fluid->ux);
+  return 0;
+}
+
+/**
+ * @brief correct ux in a tile using scalar potential psi
+ * @param[in]     domain    : information about domain decomposition and size
+ * @param[in]     prefactor : pre-factor in front of grad psi
+ * @param[in]     is, ie    : range of the tile, x faces [max(is, 2) : ie] are updated
+ * @param[in,out] fluid     : scalar potential psi (in), ux (out)
+ * @return                  : error code
+ */
+int fluid_correct_velocity_ux(
+    const domain_t * domain,
+    const double prefactor,
+    const int is,
+    const int ie,
+    fluid_t * fluid
+){
+  bool x_grid_is_uniform = false;
+  domain_check_x_grid_is_uniform(domain, &x_grid_is_uniform);
+  if(x_grid_is_uniform){
+    kernel(domain, true, prefactor, is, ie, fluid);
+  }else{
+    kernel(domain, false, prefactor, is, ie, fluid);
+  }
   return 0;
 }
 
@@ -1,40 +1,43 @@
 #include "domain.h"
 #include "fluid.h"
 #include "fluid_solver.h"
+#include "threads.h"
 #include "internal.h"
 #include "array_macros/fluid/uy.h"
 #include "array_macros/fluid/psi.h"
 
 /**
- * @brief correct uy using scalar potential psi
+ * @brief correct uy in a tile using scalar potential psi
  * @param[in]     domain    : information about domain decomposition and size
  * @param[in]     prefactor : pre-factor in front of grad psi
+ * @param[in]     is, ie    : range of the tile, cells [is : ie] are updated
  * @param[in,out] fluid     : scalar potential psi (in), uy (out)
  * @return                  : error code
  */
 int fluid_correct_velocity_uy(
     const domain_t * domain,
     const double prefactor,
+    const int is,
+    const int ie,
     fluid_t * fluid
 ){
   const int isize = domain->mysizes[0];
   const int jsize = domain->mysizes[1];
-  const double dy = domain->dy;
+  const double dyinv = domain->dyinv;
   const double * restrict psi = fluid->psi.data;
   double * restrict uy = fluid->uy.data;
+  THREADS_PRAGMA(omp parallel for schedule(static))
   for(int j = 1; j <= jsize; j++){
-    for(int i = 1; i <= isize; i++){
+    for(int i = is; i <= ie; i++){
       // correct y velocity
       double psi_ym = PSI(i  , j-1);
       double psi_yp = PSI(i  , j  );
-      UY(i, j) -= prefactor / dy * (
+      UY(i, j) -= prefactor * dyinv * (
           + psi_yp
           - psi_ym
       );
     }
   }
-  // update boundary and halo cells
-  fluid_update_boundaries_uy(domain, &fluid->uy);
   return 0;
 }
 
@@ -9,6 +9,7 @@
 #include "sdecomp.h"
 #include "domain.h"
 #include "fluid.h"
+#include "threads.h"
 #include "array_macros/fluid/ux.h"
 #include "array_macros/fluid/uy.h"
 #include "array_macros/domain/dxc.h"
@@ -40,24 +41,29 @@ static int decide_dt_adv(
   const double * restrict uy = fluid->uy.data;
   // sufficiently small number to avoid zero division
   const double small = 1.e-8;
-  *dt = 1.; // max possible dt
+  // max possible dt
+  // NOTE: a local variable is used for the thread reduction
+  double dtmin = 1.;
   // compute grid-size over velocity in x
+  THREADS_PRAGMA(omp parallel for schedule(static) reduction(min: dtmin))
   for(int j = 1; j <= jsize; j++){
     for(int i = 2; i <= isize; i++){
       const double dx = DXC(i  );
       double vel = fabs(UX(i, j)) + small;
-      *dt = fmin(*dt, dx / vel);
+      dtmin = fmin(dtmin, dx / vel);
     }
   }
   // compute grid-size over velocity in y
+  THREADS_PRAGMA(omp parallel for schedule(static) reduction(min: dtmin))
   for(int j = 1; j <= jsize; j++){
     for(int i = 1; i <= isize; i++){
       double vel = fabs(UY(i, j)) + small;
-      *dt = fmin(*dt, dy / vel);
+      dtmin = fmin(dtmin, dy / vel);
     }
   }
   // compute grid-size over velocity in z
   // unify result, multiply safety factor
+  *dt = dtmin;
   MPI_Allreduce(MPI_IN_PLACE, dt, 1, MPI_DOUBLE, MPI_MIN, comm_cart);
   *dt *= coef_dt_adv;
   return 0;
@@ -1,6 +1,7 @@
 #include <math.h>
 #include "param.h"
 #include "memory.h"
+#include "runge_kutta.h"
 #include "config.h"
 #include "domain.h"
 #include "fluid.h"
@@ -34,7 +35,11 @@ static int allocate(
   // temperature
   if(0 != array.prepare(domain, T_NADDS, sizeof(double), &fluid->t)) return 1;
   // Runge-Kutta source terms
+  // NOTE: previous explicit terms are stored in [rk_g] in the low-storage mode
   for(size_t n = 0; n < 3; n++){
+    if(param_rk_low_storage && rk_b == n){
+      continue;
+    }
     if(0 != array.prepare(domain, SRCUX_NADDS, sizeof(double), &fluid->srcux[n])) return 1;
     if(0 != array.prepare(domain, SRCUY_NADDS, sizeof(double), &fluid->srcuy[n])) return 1;
     if(0 != array.prepare(domain, SRCT_NADDS,  sizeof(double), &fluid->srct [n])) return 1;
@@ -57,6 +62,7 @@ static void report(
     printf("\tTemperature diffusivity: % .7e\n", fluid->t_dif);
     printf("\tdiffusive treatment in x: %s\n", param_m_implicit_x ? "implicit" : "explicit");
     printf("\tdiffusive treatment in y: %s\n", param_m_implicit_y ? "implicit" : "explicit");
+    printf("\tRunge-Kutta source terms: %s\n", param_rk_low_storage ? "low-storage" : "standard");
     fflush(stdout);
   }
 }
@@ -0,0 +1,422 @@
+#include "param.h"
+#include "memory.h"
+#include "runge_kutta.h"
+#include "domain.h"
+#include "fluid.h"
+#include "interface.h"
+#include "threads.h"
+#include "internal.h"
+#include "array_macros/domain/dxf.h"
+#include "array_macros/domain/dxc.h"
+#include "array_macros/domain/dxfinv.h"
+#include "array_macros/domain/dxcinv.h"
+#include "array_macros/domain/wxm.h"
+#include "array_macros/domain/wxp.h"
+#include "array_macros/fluid/ux.h"
+#include "array_macros/fluid/uy.h"
+#include "array_macros/fluid/p.h"
+#include "array_macros/fluid/t.h"
+
+// right-hand-side terms of ux, uy and T computed together,
+//   walking the domain (or a tile of it) once row by row
+// advecting velocities interpolated to the cell centers and corners
+//   are computed once and shared by the neighbouring stencils
+//   and by the different components,
+//   while the rows of the flow field are still cached
+
+// store approximation of laplacian
+typedef double laplacian_t[3];
+
+// interpolated velocities
+// uxc: ux at the cell centers of the row
+// uxe: ux at the lower corners of the row
+// uyc: uy at the cell centers of the row, two rows
+// uye: uy at the lower corners of the row, two rows
+typedef struct {
+  double * uxc;
+  double * uxe;
+  double * uyc[2];
+  double * uye[2];
+} rows_t;
+
+typedef struct {
+  bool is_initialised;
+  // x laplacians at the x faces (ux) and at the cell centers (uy, T)
+  laplacian_t * lapxf;
+  laplacian_t * lapxc;
+  // y laplacian, common for all
+  laplacian_t lapy;
+  // interpolated velocities, one set per thread
+  rows_t * rows;
+} buffers_t;
+
+static buffers_t buffers = {
+  .is_initialised = false,
+};
+
+// [2 : isize]
+#define LAPXF(I) lapxf[(I)-2]
+// [1 : isize]
+#define LAPXC(I) lapxc[(I)-1]
+
+static int init_buffers(
+    const domain_t * domain
+){
+  const size_t isize = domain->glsizes[0];
+  const double * dxf = domain->dxf;
+  const double * dxc = domain->dxc;
+  // Laplacian w.r.t. ux in x
+  {
+    laplacian_t * lapxf = buffers.lapxf = memory_calloc(isize - 1, sizeof(laplacian_t));
+    for(size_t i = 2; i <= isize; i++){
+      const double l = 1. / DXF(i-1) / DXC(i  );
+      const double u = 1. / DXF(i  ) / DXC(i  );
+      const double c = - l - u;
+      LAPXF(i)[0] = l;
+      LAPXF(i)[1] = c;
+      LAPXF(i)[2] = u;
+    }
+  }
+  // Laplacian w.r.t. uy and T in x
+  {
+    laplacian_t * lapxc = buffers.lapxc = memory_calloc(isize, sizeof(laplacian_t));
+    for(size_t i = 1; i <= isize; i++){
+      const double l = 1. / DXC(i  ) / DXF(i  );
+      const double u = 1. / DXC(i+1) / DXF(i  );
+      const double c = - l - u;
+      LAPXC(i)[0] = l;
+      LAPXC(i)[1] = c;
+      LAPXC(i)[2] = u;
+    }
+  }
+  // Laplacian in y
+  {
+    const double dy = domain->dy;
+    buffers.lapy[0] = + 1. / dy / dy;
+    buffers.lapy[1] = - 2. / dy / dy;
+    buffers.lapy[2] = + 1. / dy / dy;
+  }
+  // row buffers, indexed by the x index directly
+  const int nthreads = threads_get_nthreads();
+  buffers.rows = memory_calloc(nthreads, sizeof(rows_t));
+  for(int m = 0; m < nthreads; m++){
+    rows_t * rows = buffers.rows + m;
+    rows->uxc = memory_calloc(isize + 2, sizeof(double));
+    rows->uxe = memory_calloc(isize + 2, sizeof(double));
+    for(size_t n = 0; n < 2; n++){
+      rows->uyc[n] = memory_calloc(isize + 2, sizeof(double));
+      rows->uye[n] = memory_calloc(isize + 2, sizeof(double));
+    }
+  }
+  buffers.is_initialised = true;
+  return 0;
+}
+
+// uy at the cell centers of the row j, [is : ie]
+static int interpolate_uyc(
+    const int isize,
+    const int is,
+    const int ie,
+    const double * restrict uy,
+    const int j,
+    double * restrict uyc
+){
+  for(int i = is; i <= ie; i++){
+    uyc[i] = + 0.5 * UY(i  , j  ) + 0.5 * UY(i  , j+1);
+  }
+  return 0;
+}
+
+// uy at the lower corners of the row j, [is : ie]
+static inline int interpolate_uye(
+    const int isize,
+    const int is,
+    const int ie,
+    const bool is_uniform,
+    const double * restrict wxm,
+    const double * restrict wxp,
+    const double * restrict uy,
+    const int j,
+    double * restrict uye
+){
+  for(int i = is; i <= ie; i++){
+    const double w_xm = is_uniform ? 0.5 : WXM(i  );
+    const double w_xp = is_uniform ? 0.5 : WXP(i  );
+    uye[i] = w_xm * UY(i-1, j  ) + w_xp * UY(i  , j  );
+  }
+  return 0;
+}
+
+// sweep over a tile, which is specialised for uniform x grids
+//   by giving a constant "is_uniform"
+static inline int kernel(
+    const domain_t * domain,
+    const bool is_uniform,
+    const int is,
+    const int ie,
+    fluid_t * fluid
+){
+  const int isize = domain->mysizes[0];
+  const int jsize = domain->mysizes[1];
+  // x faces in the tile (ux), the left-most wall face is excluded
+  const int isx = 2 < is ? is : 2;
+  const double * restrict dxfinv = domain->dxfinv;
+  const double * restrict dxcinv = domain->dxcinv;
+  const double * restrict wxm = domain->wxm;
+  const double * restrict wxp = domain->wxp;
+  // constant metric of uniform grids
+  const double dxinv = domain->dxfinv[0];
+  const double dyinv = domain->dyinv;
+  const laplacian_t * restrict lapxf = buffers.lapxf;
+  const laplacian_t * restrict lapxc = buffers.lapxc;
+  const laplacian_t * restrict lapy = &buffers.lapy;
+  const double * restrict ux = fluid->ux.data;
+  const double * restrict uy = fluid->uy.data;
+  const double * restrict  p = fluid-> p.data;
+  const double * restrict  t = fluid-> t.data;
+  double * restrict srcuxa = fluid->srcux[rk_a].data;
+  double * restrict srcuxg = fluid->srcux[rk_g].data;
+  double * restrict srcuya = fluid->srcuy[rk_a].data;
+  double * restrict srcuyg = fluid->srcuy[rk_g].data;
+  double * restrict srcta  = fluid->srct [rk_a].data;
+  double * restrict srctg  = fluid->srct [rk_g].data;
+  const double m_dif = fluid->m_dif;
+  const double t_dif = fluid->t_dif;
+  const bool m_implicit_x = param_m_implicit_x;
+  const bool m_implicit_y = param_m_implicit_y;
+  const bool t_implicit_x = param_t_implicit_x;
+  const bool t_implicit_y = param_t_implicit_y;
+  const bool add_buoyancy = param_add_buoyancy;
+  // previous explicit terms are added to the implicit ones in the low-storage mode
+  const bool low_storage = param_rk_low_storage;
+  // the rows are split into contiguous chunks, one per thread,
+  //   each of which is walked from the bottom using its own buffers
+  const int nchunks = threads_get_nthreads();
+  THREADS_PRAGMA(omp parallel for schedule(static))
+  for(int chunk = 0; chunk < nchunks; chunk++){
+    const int js = 1 + jsize *  chunk      / nchunks;
+    const int je =     jsize * (chunk + 1) / nchunks;
+    const rows_t * rows = buffers.rows + threads_get_mythread();
+    double * restrict uxc = rows->uxc;
+    double * restrict uxe = rows->uxe;
+    // y-interpolated values of the row j are stored in [j % 2],
+    //   prepare the lowest ones of the chunk
+    interpolate_uyc(isize, is, ie, uy, js - 1, rows->uyc[(js - 1) % 2]);
+    interpolate_uye(isize, isx, ie, is_uniform, wxm, wxp, uy, js, rows->uye[js % 2]);
+    for(int j = js; j <= je; j++){
+      // interpolate advecting velocities
+      for(int i = isx - 1; i <= ie; i++){
+        uxc[i] = + 0.5 * UX(i  , j  ) + 0.5 * UX(i+1, j  );
+      }
+      for(int i = is; i <= ie + 1; i++){
+        uxe[i] = + 0.5 * UX(i  , j-1) + 0.5 * UX(i  , j  );
+      }
+      interpolate_uyc(isize, is, ie, uy, j, rows->uyc[(j    ) % 2]);
+      interpolate_uye(isize, isx, ie, is_uniform, wxm, wxp, uy, j + 1, rows->uye[(j + 1) % 2]);
+      const double * restrict uycm = rows->uyc[(j - 1) % 2];
+      const double * restrict uycp = rows->uyc[(j    ) % 2];
+      const double * restrict uyem = rows->uye[(j    ) % 2];
+      const double * restrict uyep = rows->uye[(j + 1) % 2];
+      // offsets of the source terms, which have no halo
+      const int cntux = (isize - 1) * (j - 1);
+      const int cntuy = (isize    ) * (j - 1);
+      const int cntt  = (isize    ) * (j - 1);
+      // ux, [isx : ie]
+      for(int i = isx; i <= ie; i++){
+        // x metric at this face
+        const double lxinv = is_uniform ? dxinv : DXCINV(i  );
+        double expl = 0.;
+        double impl = 0.;
+        // ux is transported by ux
+        {
+          const double l = + 0.5 * lxinv * uxc[i - 1];
+          const double u = - 0.5 * lxinv * uxc[i    ];
+          const double c = - l - u;
+          expl +=
+            + l * UX(i-1, j  )
+            + c * UX(i  , j  )
+            + u * UX(i+1, j  );
+        }
+        // ux is transported by uy
+        {
+          const double l = + 0.5 * dyinv * uyem[i];
+          const double u = - 0.5 * dyinv * uyep[i];
+          const double c = - l - u;
+          expl +=
+            + l * UX(i  , j-1)
+            + c * UX(i  , j  )
+            + u * UX(i  , j+1);
+        }
+        // ux is diffused in x and in y
+        const double difx = m_dif * (
+            + LAPXF(i)[0] * UX(i-1, j  )
+            + LAPXF(i)[1] * UX(i  , j  )
+            + LAPXF(i)[2] * UX(i+1, j  )
+        );
+        const double dify = m_dif * (
+            + (*lapy)[0] * UX(i  , j-1)
+            + (*lapy)[1] * UX(i  , j  )
+            + (*lapy)[2] * UX(i  , j+1)
+        );
+        if(m_implicit_x){
+          impl += difx;
+        }else{
+          expl += difx;
+        }
+        if(m_implicit_y){
+          impl += dify;
+        }else{
+          expl += dify;
+        }
+        // pressure gradient
+        impl -= lxinv * (
+            - P(i-1, j  )
+            + P(i  , j  )
+        );
+        // buoyancy force (Boussinesq approximation)
+        if(add_buoyancy){
+          expl +=
+            + 0.5 * T(i-1, j  )
+            + 0.5 * T(i  , j  );
+        }
+        srcuxa[cntux + i - 2] = expl;
+        srcuxg[cntux + i - 2] = low_storage ? srcuxg[cntux + i - 2] + impl : impl;
+      }
+      // uy, [is : ie]
+      for(int i = is; i <= ie; i++){
+        // x metric at this cell
+        const double lxinv = is_uniform ? dxinv : DXFINV(i  );
+        double expl = 0.;
+        double impl = 0.;
+        // uy is transported by ux
+        {
+          const double l = + 0.5 * lxinv * uxe[i    ];
+          const double u = - 0.5 * lxinv * uxe[i + 1];
+          const double c = - l - u;
+          expl +=
+            + l * UY(i-1, j  )
+            + c * UY(i  , j  )
+            + u * UY(i+1, j  );
+        }
+        // uy is transported by uy
+        {
+          const double l = + 0.5 * dyinv * uycm[i];
+          const double u = - 0.5 * dyinv * uycp[i];
+          const double c = - l - u;
+          expl +=
+            + l * UY(i  , j-1)
+            + c * UY(i  , j  )
+            + u * UY(i  , j+1);
+        }
+        // uy is diffused in x and in y
+        const double difx = m_dif * (
+            + LAPXC(i)[0] * UY(i-1, j  )
+            + LAPXC(i)[1] * UY(i  , j  )
+            + LAPXC(i)[2] * UY(i+1, j  )
+        );
+        const double dify = m_dif * (
+            + (*lapy)[0] * UY(i  , j-1)
+            + (*lapy)[1] * UY(i  , j  )
+            + (*lapy)[2] * UY(i  , j+1)
+        );
+        if(m_implicit_x){
+          impl += difx;
+        }else{
+          expl += difx;
+        }
+        if(m_implicit_y){
+          impl += dify;
+        }else{
+          expl += dify;
+        }
+        // pressure gradient
+        impl -= dyinv * (
+            - P(i  , j-1)
+            + P(i  , j  )
+        );
+        srcuya[cntuy + i - 1] = expl;
+        srcuyg[cntuy + i - 1] = low_storage ? srcuyg[cntuy + i - 1] + impl : impl;
+      }
+      // T, [is : ie]
+      for(int i = is; i <= ie; i++){
+        // x metric at this cell
+        const double lxinv = is_uniform ? dxinv : DXFINV(i  );
+        double expl = 0.;
+        double impl = 0.;
+        // T is transported by ux
+        {
+          const double l = + 0.5 * lxinv * UX(i  , j  );
+          const double u = - 0.5 * lxinv * UX(i+1, j  );
+          const double c = - l - u;
+          expl +=
+            + l * T(i-1, j  )
+            + c * T(i  , j  )
+            + u * T(i+1, j  );
+        }
+        // T is transported by uy
+        {
+          const double l = + 0.5 * dyinv * UY(i  , j  );
+          const double u = - 0.5 * dyinv * UY(i  , j+1);
+          const double c = - l - u;
+          expl +=
+            + l * T(i  , j-1)
+            + c * T(i  , j  )
+            + u * T(i  , j+1);
+        }
+        // T is diffused in x and in y
+        const double difx = t_dif * (
+            + LAPXC(i)[0] * T(i-1, j  )
+            + LAPXC(i)[1] * T(i  , j  )
+            + LAPXC(i)[2] * T(i+1, j  )
+        );
+        const double dify = t_dif * (
+            + (*lapy)[0] * T(i  , j-1)
+            + (*lapy)[1] * T(i  , j  )
+            + (*lapy)[2] * T(i  , j+1)
+        );
+        if(t_implicit_x){
+          impl += difx;
+        }else{
+          expl += difx;
+        }
+        if(t_implicit_y){
+          impl += dify;
+        }else{
+          expl += dify;
+        }
+        srcta[cntt + i - 1] = expl;
+        srctg[cntt + i - 1] = low_storage ? srctg[cntt + i - 1] + impl : impl;
+      }
+    }
+  }
+  return 0;
+}
+
+/**
+ * @brief compute right-hand-side terms of ux, uy and T in one sweep
+ * @param[in]     domain : information related to MPI domain decomposition
+ * @param[in]     is, ie : range of the tile, cells [is : ie] are updated
+ * @param[in,out] fluid  : n-step flow field (in), RK source terms (out)
+ * @return               : error code
+ */
+int compute_rhs_combined(
+    const domain_t * domain,
+    const int is,
+    const int ie,
+    fluid_t * fluid
+){
+  if(!buffers.is_initialised){
+    if(0 != init_buffers(domain)){
+      return 1;
+    }
+  }
+  bool x_grid_is_uniform = false;
+  domain_check_x_grid_is_uniform(domain, &x_grid_is_uniform);
+  if(x_grid_is_uniform){
+    kernel(domain, true, is, ie, fluid);
+  }else{
+    kernel(domain, false, is, ie, fluid);
+  }
+  return 0;
+}
+
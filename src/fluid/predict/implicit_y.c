@@ -0,0 +1,261 @@
+#include <string.h>
+#include "param.h"
+#include "memory.h"
+#include "runge_kutta.h"
+#include "sdecomp.h"
+#include "tdm.h"
+#include "domain.h"
+#include "fluid.h"
+#include "threads.h"
+#include "internal.h"
+
+// increments of ux, uy and T which are treated implicitly in y
+//   are solved together:
+//   their x1 pencils are packed side by side in x,
+//   [ ux (isize - 1) | uy (isize) | T (isize) ],
+//   so that one pair of transposes is needed per Runge-Kutta stage
+//   instead of one pair per field
+// NOTE: fields which are explicit in y are not packed
+// NOTE: in the y1 pencil, each column belongs to one of the fields,
+//   and the columns of the momentum (ux, uy) come first,
+//   followed by those of the temperature
+// NOTE: when a single process owns the whole columns,
+//   the systems are solved in place in the packed x1 pencil,
+//   whose columns are interleaved, and no transpose is needed
+
+typedef struct {
+  bool is_initialised;
+  // solved in the x1 pencil (single process) or in the y1 pencil
+  bool is_single;
+  // number of packed columns of each field, 0 if not packed
+  size_t ncols[3];
+  // size of the packed array
+  size_t glsizes[NDIMS];
+  // packed pencils
+  double * restrict x1pncl;
+  double * restrict y1pncl;
+  size_t y1pncl_mysizes[NDIMS];
+  // number of local columns of the y1 pencil,
+  //   which belong to the momentum and to the temperature
+  size_t nsystems[2];
+  tdm_info_t * tdm_y[2];
+  // factorisation of each group, which is renewed every solve
+  //   as the matrix depends on the time step size
+  tdm_factor_t * factors[2];
+  sdecomp_transpose_plan_t * transposer_x1_to_y1;
+  sdecomp_transpose_plan_t * transposer_y1_to_x1;
+} batch_t;
+
+static batch_t batch = {
+  .is_initialised = false,
+};
+
+static int init(
+    const domain_t * domain
+){
+  const sdecomp_info_t * info = domain->info;
+  const size_t nx = domain->glsizes[0];
+  size_t * ncols = batch.ncols;
+  ncols[0] = param_m_implicit_y ? nx - 1 : 0;
+  ncols[1] = param_m_implicit_y ? nx     : 0;
+  ncols[2] = param_t_implicit_y ? nx     : 0;
+  size_t * glsizes = batch.glsizes;
+  glsizes[0] = ncols[0] + ncols[1] + ncols[2];
+  glsizes[1] = domain->glsizes[1];
+  // packed pencils
+  size_t x1pncl_mysizes[NDIMS] = {0};
+  size_t * y1pncl_mysizes = batch.y1pncl_mysizes;
+  for(int dim = 0; dim < NDIMS; dim++){
+    if(0 != sdecomp.get_pencil_mysize(info, SDECOMP_X1PENCIL, dim, glsizes[dim], x1pncl_mysizes + dim)) return 1;
+    if(0 != sdecomp.get_pencil_mysize(info, SDECOMP_Y1PENCIL, dim, glsizes[dim], y1pncl_mysizes + dim)) return 1;
+  }
+  batch.x1pncl = memory_calloc(x1pncl_mysizes[0] * x1pncl_mysizes[1], sizeof(double));
+  int nprocs = 1;
+  sdecomp.get_comm_size(info, &nprocs);
+  batch.is_single = 1 == nprocs;
+  if(batch.is_single){
+    batch.y1pncl = NULL;
+    batch.transposer_x1_to_y1 = NULL;
+    batch.transposer_y1_to_x1 = NULL;
+  }else{
+    batch.y1pncl = memory_calloc(y1pncl_mysizes[0] * y1pncl_mysizes[1], sizeof(double));
+    // one pair of transposes for all fields
+    if(0 != sdecomp.transpose.construct(info, SDECOMP_X1PENCIL, SDECOMP_Y1PENCIL, glsizes, sizeof(double), &batch.transposer_x1_to_y1)) return 1;
+    if(0 != sdecomp.transpose.construct(info, SDECOMP_Y1PENCIL, SDECOMP_X1PENCIL, glsizes, sizeof(double), &batch.transposer_y1_to_x1)) return 1;
+  }
+  // local columns of the y1 pencil belonging to the momentum,
+  //   the rest belongs to the temperature
+  size_t offset = 0;
+  if(0 != sdecomp.get_pencil_offset(info, SDECOMP_Y1PENCIL, SDECOMP_XDIR, glsizes[0], &offset)) return 1;
+  const size_t ncols_m = ncols[0] + ncols[1];
+  const size_t nlocal = y1pncl_mysizes[0];
+  size_t * nsystems = batch.nsystems;
+  nsystems[0] = ncols_m <= offset ? 0 : ncols_m - offset;
+  nsystems[0] = nlocal < nsystems[0] ? nlocal : nsystems[0];
+  nsystems[1] = nlocal - nsystems[0];
+  // periodic tri-diagonal systems in y, one solver per group
+  for(size_t n = 0; n < 2; n++){
+    batch.tdm_y[n] = NULL;
+    batch.factors[n] = NULL;
+    if(0 == nsystems[n]){
+      continue;
+    }
+    if(0 != tdm.construct(
+        /* size of system */ (int)(y1pncl_mysizes[1]),
+        /* number of rhs  */ (int)(nsystems[n]),
+        /* is periodic    */ true,
+        /* is complex     */ false,
+        /* output         */ batch.tdm_y + n
+    )) return 1;
+  }
+  batch.is_initialised = true;
+  return 0;
+}
+
+// copy the increments of a field to / from the packed x1 pencil
+static int pack(
+    const size_t jsize,
+    const size_t ncols,
+    const size_t offset,
+    const double * restrict dq,
+    double * restrict x1pncl
+){
+  const size_t stride = batch.glsizes[0];
+  THREADS_PRAGMA(omp parallel for schedule(static))
+  for(size_t j = 0; j < jsize; j++){
+    memcpy(x1pncl + stride * j + offset, dq + ncols * j, sizeof(double) * ncols);
+  }
+  return 0;
+}
+
+static int unpack(
+    const size_t jsize,
+    const size_t ncols,
+    const size_t offset,
+    const double * restrict x1pncl,
+    double * restrict dq
+){
+  const size_t stride = batch.glsizes[0];
+  THREADS_PRAGMA(omp parallel for schedule(static))
+  for(size_t j = 0; j < jsize; j++){
+    memcpy(dq + ncols * j, x1pncl + stride * j + offset, sizeof(double) * ncols);
+  }
+  return 0;
+}
+
+static int solve_factorised(
+    const tdm_info_t * tdm_info,
+    const tdm_factor_t * factor,
+    double * restrict q
+){
+  if(batch.is_single){
+    // columns of the x1 pencil, the others in the packed array are skipped
+    return tdm.solve_factorised_strided(tdm_info, factor, batch.glsizes[0], q);
+  }
+  return tdm.solve_factorised(tdm_info, factor, q);
+}
+
+static int solve(
+    const size_t n,
+    const double prefactor,
+    const double dy,
+    double * restrict q
+){
+  tdm_info_t * tdm_info = batch.tdm_y[n];
+  tdm_factor_t ** factor = &batch.factors[n];
+  int size = 0;
+  double * restrict tdm_l = NULL;
+  double * restrict tdm_c = NULL;
+  double * restrict tdm_u = NULL;
+  tdm.get_size(tdm_info, &size);
+  tdm.get_l(tdm_info, &tdm_l);
+  tdm.get_c(tdm_info, &tdm_c);
+  tdm.get_u(tdm_info, &tdm_u);
+  // laplacian in y
+  const double lapy[3] = {
+    + 1. / dy / dy,
+    - 2. / dy / dy,
+    + 1. / dy / dy,
+  };
+  for(int j = 0; j < size; j++){
+    tdm_l[j] =    - prefactor * lapy[0];
+    tdm_c[j] = 1. - prefactor * lapy[1];
+    tdm_u[j] =    - prefactor * lapy[2];
+  }
+  tdm.factorise(tdm_info, factor);
+  solve_factorised(tdm_info, *factor, q);
+  return 0;
+}
+
+/**
+ * @brief solve the increments of ux, uy and T implicitly in y at once
+ * @param[in]     domain : information about domain decomposition and size
+ * @param[in]     rkstep : Runge-Kutta step
+ * @param[in]     dt     : time step size
+ * @param[in]     fluid  : diffusivities
+ * @param[in,out] dux    : increment of ux in the x1 pencil, used if momentum is implicit in y
+ * @param[in,out] duy    : increment of uy in the x1 pencil, used if momentum is implicit in y
+ * @param[in,out] dtemp  : increment of T  in the x1 pencil, used if temperature is implicit in y
+ * @return               : error code
+ */
+int solve_implicit_y(
+    const domain_t * domain,
+    const size_t rkstep,
+    const double dt,
+    const fluid_t * fluid,
+    double * restrict dux,
+    double * restrict duy,
+    double * restrict dtemp
+){
+  if(!batch.is_initialised){
+    if(0 != init(domain)){
+      return 1;
+    }
+  }
+  const size_t jsize = domain->mysizes[1];
+  const size_t * ncols = batch.ncols;
+  double * dqs[3] = {dux, duy, dtemp};
+  for(size_t n = 0, offset = 0; n < 3; offset += ncols[n], n++){
+    if(0 != ncols[n]){
+      pack(jsize, ncols[n], offset, dqs[n], batch.x1pncl);
+    }
+  }
+  if(!batch.is_single){
+    sdecomp.transpose.execute(
+        batch.transposer_x1_to_y1,
+        batch.x1pncl,
+        batch.y1pncl
+    );
+  }
+  // gamma dt diffusivity / 2 of the momentum and of the temperature
+  const double prefactors[2] = {
+    0.5 * rkcoefs[rkstep][rk_g] * dt * fluid->m_dif,
+    0.5 * rkcoefs[rkstep][rk_g] * dt * fluid->t_dif,
+  };
+  const double dy = domain->dy;
+  const size_t * nsystems = batch.nsystems;
+  for(size_t n = 0, offset = 0; n < 2; offset += nsystems[n], n++){
+    if(0 == nsystems[n]){
+      continue;
+    }
+    if(batch.is_single){
+      solve(n, prefactors[n], dy, batch.x1pncl + offset);
+    }else{
+      solve(n, prefactors[n], dy, batch.y1pncl + batch.y1pncl_mysizes[1] * offset);
+    }
+  }
+  if(!batch.is_single){
+    sdecomp.transpose.execute(
+        batch.transposer_y1_to_x1,
+        batch.y1pncl,
+        batch.x1pncl
+    );
+  }
+  for(size_t n = 0, offset = 0; n < 3; offset += ncols[n], n++){
+    if(0 != ncols[n]){
+      unpack(jsize, ncols[n], offset, batch.x1pncl, dqs[n]);
+    }
+  }
+  return 0;
+}
+
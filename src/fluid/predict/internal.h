@@ -5,34 +5,59 @@
 
 extern int compute_rhs_ux(
     const domain_t * domain,
-    fluid_t * fluid,
-    const interface_t * interface
+    const int is,
+    const int ie,
+    fluid_t * fluid
 );
 
 extern int compute_rhs_uy(
     const domain_t * domain,
-    fluid_t * fluid,
-    const interface_t * interface
+    const int is,
+    const int ie,
+    fluid_t * fluid
 );
 
 
 extern int compute_rhs_t(
     const domain_t * domain,
+    const int is,
+    const int ie,
     fluid_t * fluid
 );
 
+extern int compute_rhs_combined(
+    const domain_t * domain,
+    const int is,
+    const int ie,
+    fluid_t * fluid
+);
+
+extern int surface_ux(
+    const domain_t * domain,
+    const interface_t * interface,
+    double * restrict srcux
+);
+
+extern int surface_uy(
+    const domain_t * domain,
+    const interface_t * interface,
+    double * restrict srcuy
+);
+
 extern int predict_ux(
     const domain_t * domain,
     const size_t rkstep,
     const double dt,
-    fluid_t * fluid
+    fluid_t * fluid,
+    double ** increment
 );
 
 extern int predict_uy(
     const domain_t * domain,
     const size_t rkstep,
     const double dt,
-    fluid_t * fluid
+    fluid_t * fluid,
+    double ** increment
 );
 
 
@@ -40,6 +65,35 @@ extern int predict_t(
     const domain_t * domain,
     const size_t rkstep,
     const double dt,
+    fluid_t * fluid,
+    double ** increment
+);
+
+extern int solve_implicit_y(
+    const domain_t * domain,
+    const size_t rkstep,
+    const double dt,
+    const fluid_t * fluid,
+    double * restrict dux,
+    double * restrict duy,
+    double * restrict dtemp
+);
+
+extern int update_ux(
+    const domain_t * domain,
+    const double * restrict dux,
+    fluid_t * fluid
+);
+
+extern int update_uy(
+    const domain_t * domain,
+    const double * restrict duy,
+    fluid_t * fluid
+);
+
+extern int update_t(
+    const domain_t * domain,
+    const double * restrict dtemp,
     fluid_t * fluid
 );
 
@@ -1,30 +1,34 @@
-#include <string.h>
+#include "param.h"
 #include "runge_kutta.h"
 #include "array.h"
+#include "tiling.h"
 #include "fluid.h"
 #include "fluid_solver.h"
 #include "interface.h"
 #include "internal.h"
 
-static int reset_srcs(
+static int stash_srcs(
     const size_t rkstep,
     array_t * restrict srca,
-    array_t * restrict srcb,
-    array_t * restrict srcg
+    array_t * restrict srcb
 ){
   // stash previous RK source term,
   //   which is achieved by swapping
   //   the pointers to "data"
   // NOTE: since "beta" is 0 when 0 == rkstep,
   //   this exchange is not needed
+  // NOTE: current RK source terms (exp/imp) are overwritten
+  //   by the kernels and thus zero-clearing is not needed
+  // NOTE: in the low-storage mode, previous terms are already
+  //   folded into the implicit ones, see predict_ux etc.
+  if(param_rk_low_storage){
+    return 0;
+  }
   if(0 != rkstep){
     double * tmp = srca->data;
     srca->data = srcb->data;
     srcb->data = tmp;
   }
-  // zero-clear current RK source terms (exp/imp)
-  memset(srca->data, 0, srca->datasize);
-  memset(srcg->data, 0, srcg->datasize);
   return 0;
 }
 
@@ -33,9 +37,31 @@ static int compute_rhs(
     fluid_t * fluid,
     const interface_t * interface
 ){
-  compute_rhs_ux(domain, fluid, interface);
-  compute_rhs_uy(domain, fluid, interface);
-  compute_rhs_t (domain, fluid);
+  static tiling_t tiling = {
+    .name = "fluid_compute_rhs",
+    .is_initialised = false,
+  };
+  const int isize = domain->mysizes[0];
+  int size = isize;
+  if(0 != tiling_begin(domain, &tiling, &size)){
+    return 1;
+  }
+  // all components are computed tile by tile
+  for(int is = 1; is <= isize; is += size){
+    const int ie = is + size - 1 < isize ? is + size - 1 : isize;
+    if(param_predict_combined_rhs){
+      // all components in one sweep
+      if(0 != compute_rhs_combined(domain, is, ie, fluid)) return 1;
+    }else{
+      if(0 != compute_rhs_ux(domain, is, ie, fluid)) return 1;
+      if(0 != compute_rhs_uy(domain, is, ie, fluid)) return 1;
+      if(0 != compute_rhs_t (domain, is, ie, fluid)) return 1;
+    }
+  }
+  tiling_end(domain, &tiling);
+  // surface tension force, always explicit and band-limited
+  surface_ux(domain, interface, fluid->srcux[rk_a].data);
+  surface_uy(domain, interface, fluid->srcuy[rk_a].data);
   return 0;
 }
 
@@ -45,9 +71,46 @@ static int predict(
     const double dt,
     fluid_t * fluid
 ){
-  predict_ux(domain, rkstep, dt, fluid);
-  predict_uy(domain, rkstep, dt, fluid);
-  predict_t (domain, rkstep, dt, fluid);
+  // increments, which are solved implicitly in x if needed
+  double * dux   = NULL;
+  double * duy   = NULL;
+  double * dtemp = NULL;
+  if(0 != predict_ux(domain, rkstep, dt, fluid, &dux  )) return 1;
+  if(0 != predict_uy(domain, rkstep, dt, fluid, &duy  )) return 1;
+  if(0 != predict_t (domain, rkstep, dt, fluid, &dtemp)) return 1;
+  // all fields which are implicit in y are solved together,
+  //   sharing a pair of transposes
+  if(param_m_implicit_y || param_t_implicit_y){
+    if(0 != solve_implicit_y(domain, rkstep, dt, fluid, dux, duy, dtemp)) return 1;
+  }
+  update_ux(domain, dux,   fluid);
+  update_uy(domain, duy,   fluid);
+  update_t (domain, dtemp, fluid);
+  return 0;
+}
+
+/**
+ * @brief compute right-hand-side terms of the Runge-Kutta scheme
+ * @param[in]     domain    : information related to MPI domain decomposition
+ * @param[in]     rkstep    : Runge-Kutta step
+ * @param[in,out] fluid     : flow field (in), RK source terms (in,out)
+ * @param[in]     interface : vof field and curvature
+ * @return                  : error code
+ */
+int fluid_compute_rhs(
+    const domain_t * domain,
+    const size_t rkstep,
+    fluid_t * fluid,
+    const interface_t * interface
+){
+  // copy previous k-step source term
+  stash_srcs(rkstep, fluid->srcux + rk_a, fluid->srcux + rk_b);
+  stash_srcs(rkstep, fluid->srcuy + rk_a, fluid->srcuy + rk_b);
+  stash_srcs(rkstep, fluid->srct  + rk_a, fluid->srct  + rk_b);
+  // compute right-hand-side terms of the Runge-Kutta scheme
+  if(0 != compute_rhs(domain, fluid, interface)){
+    return 1;
+  }
   return 0;
 }
 
@@ -56,22 +119,15 @@ static int predict(
  * @param[in]     domain : information related to MPI domain decomposition
  * @param[in]     rkstep : Runge-Kutta step
  * @param[in]     dt     : time step size
- * @param[in,out] fluid  : flow field (in), RK source terms (in,out)
+ * @param[in,out] fluid  : RK source terms (in), flow field (in,out)
  * @return               : error code
  */
 int fluid_predict_field(
     const domain_t * domain,
     const size_t rkstep,
     const double dt,
-    fluid_t * fluid,
-    const interface_t * interface
+    fluid_t * fluid
 ){
-  // copy previous k-step source term and reset
-  reset_srcs(rkstep, fluid->srcux + rk_a, fluid->srcux + rk_b, fluid->srcux + rk_g);
-  reset_srcs(rkstep, fluid->srcuy + rk_a, fluid->srcuy + rk_b, fluid->srcuy + rk_g);
-  reset_srcs(rkstep, fluid->srct  + rk_a, fluid->srct  + rk_b, fluid->srct  + rk_g);
-  // compute right-hand-side terms of the Runge-Kutta scheme
-  compute_rhs(domain, fluid, interface);
   // update fields, which are still the prediction for the velocity,
   //   whereas the temperature is already updated to a new value
   predict(domain, rkstep, dt, fluid);
@@ -6,9 +6,11 @@
 #include "domain.h"
 #include "fluid.h"
 #include "fluid_solver.h"
+#include "threads.h"
 #include "internal.h"
 #include "array_macros/domain/dxf.h"
 #include "array_macros/domain/dxc.h"
+#include "array_macros/domain/dxfinv.h"
 #include "array_macros/fluid/ux.h"
 #include "array_macros/fluid/uy.h"
 #include "array_macros/fluid/t.h"
@@ -59,106 +61,158 @@ static int init_lap(
 }
 
 #define BEGIN \
-  for(int cnt = 0, j = 1; j <= jsize; j++){ \
-    for(int i = 1; i <= isize; i++, cnt++){
+  THREADS_PRAGMA(omp parallel for schedule(static)) \
+  for(int j = 1; j <= jsize; j++){ \
+    for(int i = 1; i <= isize; i++){ \
+      const int cnt = isize * (j - 1) + (i - 1);
 #define END \
     } \
   }
 
-static int advection_x(
-    const domain_t * domain,
+// contributions to the right-hand-side of a single cell,
+//   which are combined by the fused kernel below
+
+static inline double advection_x(
+    const int isize,
+    const double dxinv,
     const double * restrict t,
     const double * restrict ux,
-    double * restrict src
+    const int i,
+    const int j
 ){
-  const int isize = domain->mysizes[0];
-  const int jsize = domain->mysizes[1];
-  const double * restrict dxf = domain->dxf;
-  BEGIN
-    // T is transported by ux
-    const double l = + 0.5 / DXF(i  ) * UX(i  , j  );
-    const double u = - 0.5 / DXF(i  ) * UX(i+1, j  );
-    const double c = - l - u;
-    src[cnt] +=
-      + l * T(i-1, j  )
-      + c * T(i  , j  )
-      + u * T(i+1, j  );
-  END
-  return 0;
+  // T is transported by ux
+  const double l = + 0.5 * dxinv * UX(i  , j  );
+  const double u = - 0.5 * dxinv * UX(i+1, j  );
+  const double c = - l - u;
+  return
+    + l * T(i-1, j  )
+    + c * T(i  , j  )
+    + u * T(i+1, j  );
 }
 
-static int advection_y(
-    const domain_t * domain,
+static inline double advection_y(
+    const int isize,
+    const double dyinv,
     const double * restrict t,
     const double * restrict uy,
-    double * restrict src
+    const int i,
+    const int j
 ){
-  const int isize = domain->mysizes[0];
-  const int jsize = domain->mysizes[1];
-  const double dy = domain->dy;
-  BEGIN
-    // T is transported by uy
-    const double l = + 0.5 / dy * UY(i  , j  );
-    const double u = - 0.5 / dy * UY(i  , j+1);
-    const double c = - l - u;
-    src[cnt] +=
-      + l * T(i  , j-1)
-      + c * T(i  , j  )
-      + u * T(i  , j+1);
-  END
-  return 0;
+  // T is transported by uy
+  const double l = + 0.5 * dyinv * UY(i  , j  );
+  const double u = - 0.5 * dyinv * UY(i  , j+1);
+  const double c = - l - u;
+  return
+    + l * T(i  , j-1)
+    + c * T(i  , j  )
+    + u * T(i  , j+1);
 }
 
-
-static int diffusion_x(
-    const domain_t * domain,
+static inline double diffusion_x(
+    const int isize,
+    const laplacian_t * restrict lapx,
     const double diffusivity,
     const double * restrict t,
-    double * restrict src
+    const int i,
+    const int j
 ){
-  const int isize = domain->mysizes[0];
-  const int jsize = domain->mysizes[1];
-  const laplacian_t * restrict lapx = laplacians.lapx;
-  BEGIN
-    // T is diffused in x
-    src[cnt] += diffusivity * (
-        + LAPX(i)[0] * T(i-1, j  )
-        + LAPX(i)[1] * T(i  , j  )
-        + LAPX(i)[2] * T(i+1, j  )
-    );
-  END
-  return 0;
+  // T is diffused in x
+  return diffusivity * (
+      + LAPX(i)[0] * T(i-1, j  )
+      + LAPX(i)[1] * T(i  , j  )
+      + LAPX(i)[2] * T(i+1, j  )
+  );
 }
 
-static int diffusion_y(
-    const domain_t * domain,
+static inline double diffusion_y(
+    const int isize,
+    const laplacian_t * restrict lapy,
     const double diffusivity,
     const double * restrict t,
-    double * restrict src
+    const int i,
+    const int j
 ){
+  // T is diffused in y
+  return diffusivity * (
+      + (*lapy)[0] * T(i  , j-1)
+      + (*lapy)[1] * T(i  , j  )
+      + (*lapy)[2] * T(i  , j+1)
+  );
+}
+
+// fused kernel, which is specialised for uniform x grids
+//   by giving a constant "is_uniform"
+static inline int kernel(
+    const domain_t * domain,
+    const bool is_uniform,
+    const int is,
+    const int ie,
+    fluid_t * fluid
+){
+  const double * restrict ux = fluid->ux.data;
+  const double * restrict uy = fluid->uy.data;
+  const double * restrict  t = fluid-> t.data;
+  double * restrict srca = fluid->srct[rk_a].data;
+  double * restrict srcg = fluid->srct[rk_g].data;
+  const double diffusivity = fluid->t_dif;
   const int isize = domain->mysizes[0];
   const int jsize = domain->mysizes[1];
+  const double * restrict dxfinv = domain->dxfinv;
+  // constant metric of uniform grids
+  const double dxinv = domain->dxfinv[0];
+  const double dyinv = domain->dyinv;
+  const laplacian_t * restrict lapx = laplacians.lapx;
   const laplacian_t * restrict lapy = &laplacians.lapy;
-  BEGIN
-    // T is diffused in y
-    src[cnt] += diffusivity * (
-        + (*lapy)[0] * T(i  , j-1)
-        + (*lapy)[1] * T(i  , j  )
-        + (*lapy)[2] * T(i  , j+1)
-    );
-  END
+  const bool implicit_x = param_t_implicit_x;
+  const bool implicit_y = param_t_implicit_y;
+  const bool low_storage = param_rk_low_storage;
+  // all contributions of a cell are accumulated in registers
+  //   and are stored only once, so that the source terms
+  //   need not be zero-cleared in advance
+  THREADS_PRAGMA(omp parallel for schedule(static))
+  for(int j = 1; j <= jsize; j++){
+    for(int i = is; i <= ie; i++){
+      // source terms, which have no halo and are accessed linearly
+      const int cnt = isize * (j - 1) + i - 1;
+      // x metric at this cell
+      const double lxinv = is_uniform ? dxinv : DXFINV(i  );
+      double expl = 0.;
+      double impl = 0.;
+      // advective contributions, always explicit
+      expl += advection_x(isize, lxinv, t, ux, i, j);
+      expl += advection_y(isize, dyinv, t, uy, i, j);
+      // diffusive contributions, can be explicit or implicit
+      const double difx = diffusion_x(isize, lapx, diffusivity, t, i, j);
+      const double dify = diffusion_y(isize, lapy, diffusivity, t, i, j);
+      if(implicit_x){
+        impl += difx;
+      }else{
+        expl += difx;
+      }
+      if(implicit_y){
+        impl += dify;
+      }else{
+        expl += dify;
+      }
+      srca[cnt] = expl;
+      // previous explicit terms are added in the low-storage mode
+      srcg[cnt] = low_storage ? srcg[cnt] + impl : impl;
+    }
+  }
   return 0;
 }
 
-
 /**
  * @brief comute right-hand-side of Runge-Kutta scheme
  * @param[in]     domain : information related to domain decomposition and size
+ * @param[in]     is, ie : range of the tile, cells [is : ie] are updated
  * @param[in,out] fluid  : n-step flow field (in), RK source terms (out)
  * @return               : error code
  */
 int compute_rhs_t(
     const domain_t * domain,
+    const int is,
+    const int ie,
     fluid_t * fluid
 ){
   if(!laplacians.is_initialised){
@@ -166,18 +220,13 @@ int compute_rhs_t(
       return 1;
     }
   }
-  const double * restrict ux = fluid->ux.data;
-  const double * restrict uy = fluid->uy.data;
-  const double * restrict  t = fluid-> t.data;
-  double * restrict srca = fluid->srct[rk_a].data;
-  double * restrict srcg = fluid->srct[rk_g].data;
-  const double diffusivity = fluid->t_dif;
-  // advective contributions, always explicit
-  advection_x(domain, t, ux, srca);
-  advection_y(domain, t, uy, srca);
-  // diffusive contributions, can be explicit or implicit
-  diffusion_x(domain, diffusivity, t, param_t_implicit_x ? srcg : srca);
-  diffusion_y(domain, diffusivity, t, param_t_implicit_y ? srcg : srca);
+  bool x_grid_is_uniform = false;
+  domain_check_x_grid_is_uniform(domain, &x_grid_is_uniform);
+  if(x_grid_is_uniform){
+    kernel(domain, true, is, ie, fluid);
+  }else{
+    kernel(domain, false, is, ie, fluid);
+  }
   return 0;
 }
 
@@ -204,53 +253,39 @@ static int solve_in_x(
   return 0;
 }
 
-static int solve_in_y(
-    const double prefactor,
-    linear_system_t * linear_system
-){
-  tdm_info_t * tdm_info = linear_system->tdm_y;
-  int size = 0;
-  double * restrict tdm_l = NULL;
-  double * restrict tdm_c = NULL;
-  double * restrict tdm_u = NULL;
-  tdm.get_size(tdm_info, &size);
-  tdm.get_l(tdm_info, &tdm_l);
-  tdm.get_c(tdm_info, &tdm_c);
-  tdm.get_u(tdm_info, &tdm_u);
-  const laplacian_t * restrict lapy = &laplacians.lapy;
-  for(int j = 0; j < size; j++){
-    tdm_l[j] =    - prefactor * (*lapy)[0];
-    tdm_c[j] = 1. - prefactor * (*lapy)[1];
-    tdm_u[j] =    - prefactor * (*lapy)[2];
-  }
-  tdm.solve(tdm_info, linear_system->y1pncl);
-  return 0;
-}
-
-
 /**
- * @brief predict temperature field
- * @param[in]     domain : information about domain decomposition and size
- * @param[in]     rkstep : Runge-Kutta step
- * @param[in]     dt     : time step size
- * @param[in,out] fluid  : Runge-Kutta source terms (in), temperature (out)
- * @return               : error code
+ * @brief compute increment of temperature field, which is solved implicitly in x if needed
+ * @param[in]     domain    : information about domain decomposition and size
+ * @param[in]     rkstep    : Runge-Kutta step
+ * @param[in]     dt        : time step size
+ * @param[in,out] fluid     : Runge-Kutta source terms (in,out) and diffusivity (in)
+ * @param[out]    increment : increment in the x1 pencil, whose buffer is owned by this file
+ * @return                  : error code
  */
 int predict_t(
     const domain_t * domain,
     const size_t rkstep,
     const double dt,
-    fluid_t * fluid
+    fluid_t * fluid,
+    double ** increment
 ){
+  // laplacians are needed by the implicit treatment,
+  //   even if the right-hand-side terms are computed elsewhere
+  if(!laplacians.is_initialised){
+    if(0 != init_lap(domain)){
+      return 1;
+    }
+  }
   static linear_system_t linear_system = {
     .is_initialised = false,
   };
   if(!linear_system.is_initialised){
     // if not initialised yet, prepare linear solver
-    //   for implicit diffusive term treatment
+    //   for implicit diffusive term treatment in x,
+    //   whereas y is treated together with the other fields
     const bool implicit[NDIMS] = {
       param_t_implicit_x,
-      param_t_implicit_y,
+      false,
     };
     const size_t glsizes[NDIMS] = {
       domain->glsizes[0],
@@ -267,16 +302,32 @@ int predict_t(
     const double coef_g = rkcoefs[rkstep][rk_g];
     const double * restrict srcta = fluid->srct[rk_a].data;
     const double * restrict srctb = fluid->srct[rk_b].data;
-    const double * restrict srctg = fluid->srct[rk_g].data;
+    double       * restrict srctg = fluid->srct[rk_g].data;
     const int isize = domain->mysizes[0];
     const int jsize = domain->mysizes[1];
     double * restrict dtemp = linear_system.x1pncl;
     const size_t nitems = isize * jsize;
-    for(size_t n = 0; n < nitems; n++){
-      dtemp[n] =
-        + coef_a * dt * srcta[n]
-        + coef_b * dt * srctb[n]
-        + coef_g * dt * srctg[n];
+    if(param_rk_low_storage){
+      // the implicit terms already contain coef_b / coef_g times
+      //   the previous explicit terms, which are replaced by
+      //   the current ones scaled for the next stage
+      const size_t next = (rkstep + 1) % 3;
+      const double fold = rkcoefs[next][rk_b] / rkcoefs[next][rk_g];
+      THREADS_PRAGMA(omp parallel for schedule(static))
+      for(size_t n = 0; n < nitems; n++){
+        dtemp[n] =
+          + coef_a * dt * srcta[n]
+          + coef_g * dt * srctg[n];
+        srctg[n] = fold * srcta[n];
+      }
+    }else{
+      THREADS_PRAGMA(omp parallel for schedule(static))
+      for(size_t n = 0; n < nitems; n++){
+        dtemp[n] =
+          + coef_a * dt * srcta[n]
+          + coef_b * dt * srctb[n]
+          + coef_g * dt * srctg[n];
+      }
     }
   }
   // gamma dt diffusivity / 2
@@ -289,34 +340,29 @@ int predict_t(
         &linear_system
     );
   }
-  // solve linear systems in y
-  if(param_t_implicit_y){
-    sdecomp.transpose.execute(
-        linear_system.transposer_x1_to_y1,
-        linear_system.x1pncl,
-        linear_system.y1pncl
-    );
-    solve_in_y(
-        prefactor,
-        &linear_system
-    );
-    sdecomp.transpose.execute(
-        linear_system.transposer_y1_to_x1,
-        linear_system.y1pncl,
-        linear_system.x1pncl
-    );
-  }
-  // the field is actually updated here
-  {
-    const int isize = domain->mysizes[0];
-    const int jsize = domain->mysizes[1];
-    const double * restrict dtemp = linear_system.x1pncl;
-    double * restrict t = fluid->t.data;
-    BEGIN
-      T(i, j) += dtemp[cnt];
-    END
-    fluid_update_boundaries_t(domain, &fluid->t);
-  }
+  *increment = linear_system.x1pncl;
+  return 0;
+}
+
+/**
+ * @brief update temperature field using the increment
+ * @param[in]     domain : information about domain decomposition and size
+ * @param[in]     dtemp  : increment in the x1 pencil
+ * @param[in,out] fluid  : temperature
+ * @return               : error code
+ */
+int update_t(
+    const domain_t * domain,
+    const double * restrict dtemp,
+    fluid_t * fluid
+){
+  const int isize = domain->mysizes[0];
+  const int jsize = domain->mysizes[1];
+  double * restrict t = fluid->t.data;
+  BEGIN
+    T(i, j) += dtemp[cnt];
+  END
+  fluid_update_boundaries_t(domain, &fluid->t);
   return 0;
 }
 
@@ -8,13 +8,21 @@
 #include "fluid_solver.h"
 #include "interface.h"
 #include "interface_solver.h"
+#include "threads.h"
 #include "internal.h"
 #include "array_macros/domain/dxf.h"
 #include "array_macros/domain/dxc.h"
+#include "array_macros/domain/dxcinv.h"
+#include "array_macros/domain/wxm.h"
+#include "array_macros/domain/wxp.h"
 #include "array_macros/fluid/ux.h"
 #include "array_macros/fluid/uy.h"
 #include "array_macros/fluid/p.h"
 #include "array_macros/fluid/t.h"
+#include "array_macros/fluid/srcux.h"
+#include "array_macros/interface/vof.h"
+#include "array_macros/interface/band.h"
+#include "array_macros/interface/curv.h"
 
 // store approximation of laplacian
 typedef double laplacian_t[3];
@@ -62,189 +70,262 @@ static int init_lap(
 }
 
 #define BEGIN \
-  for(int cnt = 0, j = 1; j <= jsize; j++){ \
-    for(int i = 2; i <= isize; i++, cnt++){
+  THREADS_PRAGMA(omp parallel for schedule(static)) \
+  for(int j = 1; j <= jsize; j++){ \
+    for(int i = 2; i <= isize; i++){ \
+      const int cnt = (isize - 1) * (j - 1) + (i - 2);
 #define END \
     } \
   }
 
-static int advection_x(
-    const domain_t * domain,
+// contributions to the right-hand-side of a single cell,
+//   which are combined by the fused kernel below
+
+static inline double advection_x(
+    const int isize,
+    const double dxinv,
     const double * restrict ux,
-    double * restrict src
+    const int i,
+    const int j
 ){
-  const int isize = domain->mysizes[0];
-  const int jsize = domain->mysizes[1];
-  const double * restrict dxc = domain->dxc;
-  BEGIN
-    // ux is transported by ux
-    const double ux_l = + 0.5 * UX(i-1, j  ) + 0.5 * UX(i  , j  );
-    const double ux_u = + 0.5 * UX(i  , j  ) + 0.5 * UX(i+1, j  );
-    const double l = + 0.5 / DXC(i  ) * ux_l;
-    const double u = - 0.5 / DXC(i  ) * ux_u;
-    const double c = - l - u;
-    src[cnt] +=
-      + l * UX(i-1, j  )
-      + c * UX(i  , j  )
-      + u * UX(i+1, j  );
-  END
-  return 0;
+  // ux is transported by ux
+  const double ux_l = + 0.5 * UX(i-1, j  ) + 0.5 * UX(i  , j  );
+  const double ux_u = + 0.5 * UX(i  , j  ) + 0.5 * UX(i+1, j  );
+  const double l = + 0.5 * dxinv * ux_l;
+  const double u = - 0.5 * dxinv * ux_u;
+  const double c = - l - u;
+  return
+    + l * UX(i-1, j  )
+    + c * UX(i  , j  )
+    + u * UX(i+1, j  );
 }
 
-static int advection_y(
-    const domain_t * domain,
+static inline double advection_y(
+    const int isize,
+    const double w_xm,
+    const double w_xp,
+    const double dyinv,
     const double * restrict ux,
     const double * restrict uy,
-    double * restrict src
+    const int i,
+    const int j
 ){
-  const int isize = domain->mysizes[0];
-  const int jsize = domain->mysizes[1];
-  const double * restrict dxf = domain->dxf;
-  const double * restrict dxc = domain->dxc;
-  const double dy = domain->dy;
-  BEGIN
-    // ux is transported by uy
-    const double w_xm = 0.5 * DXF(i-1) / DXC(i  );
-    const double w_xp = 0.5 * DXF(i  ) / DXC(i  );
-    const double uy_l = w_xm * UY(i-1, j  ) + w_xp * UY(i  , j  );
-    const double uy_u = w_xm * UY(i-1, j+1) + w_xp * UY(i  , j+1);
-    const double l = + 0.5 / dy * uy_l;
-    const double u = - 0.5 / dy * uy_u;
-    const double c = - l - u;
-    src[cnt] +=
-      + l * UX(i  , j-1)
-      + c * UX(i  , j  )
-      + u * UX(i  , j+1);
-  END
-  return 0;
+  // ux is transported by uy
+  const double uy_l = w_xm * UY(i-1, j  ) + w_xp * UY(i  , j  );
+  const double uy_u = w_xm * UY(i-1, j+1) + w_xp * UY(i  , j+1);
+  const double l = + 0.5 * dyinv * uy_l;
+  const double u = - 0.5 * dyinv * uy_u;
+  const double c = - l - u;
+  return
+    + l * UX(i  , j-1)
+    + c * UX(i  , j  )
+    + u * UX(i  , j+1);
 }
 
-
-static int diffusion_x(
-    const domain_t * domain,
+static inline double diffusion_x(
+    const int isize,
+    const laplacian_t * restrict lapx,
     const double diffusivity,
     const double * restrict ux,
-    double * restrict src
+    const int i,
+    const int j
 ){
-  const int isize = domain->mysizes[0];
-  const int jsize = domain->mysizes[1];
-  const laplacian_t * restrict lapx = laplacians.lapx;
-  BEGIN
-    // ux is diffused in x
-    src[cnt] += diffusivity * (
-        + LAPX(i)[0] * UX(i-1, j  )
-        + LAPX(i)[1] * UX(i  , j  )
-        + LAPX(i)[2] * UX(i+1, j  )
-    );
-  END
-  return 0;
+  // ux is diffused in x
+  return diffusivity * (
+      + LAPX(i)[0] * UX(i-1, j  )
+      + LAPX(i)[1] * UX(i  , j  )
+      + LAPX(i)[2] * UX(i+1, j  )
+  );
 }
 
-static int diffusion_y(
-    const domain_t * domain,
+static inline double diffusion_y(
+    const int isize,
+    const laplacian_t * restrict lapy,
     const double diffusivity,
     const double * restrict ux,
-    double * restrict src
+    const int i,
+    const int j
 ){
-  const int isize = domain->mysizes[0];
-  const int jsize = domain->mysizes[1];
-  const laplacian_t * restrict lapy = &laplacians.lapy;
-  BEGIN
-    // ux is diffused in y
-    src[cnt] += diffusivity * (
-        + (*lapy)[0] * UX(i  , j-1)
-        + (*lapy)[1] * UX(i  , j  )
-        + (*lapy)[2] * UX(i  , j+1)
-    );
-  END
-  return 0;
+  // ux is diffused in y
+  return diffusivity * (
+      + (*lapy)[0] * UX(i  , j-1)
+      + (*lapy)[1] * UX(i  , j  )
+      + (*lapy)[2] * UX(i  , j+1)
+  );
 }
 
-
-static int pressure(
-    const domain_t * domain,
+static inline double pressure(
+    const int isize,
+    const double dxinv,
     const double * restrict p,
-    double * restrict src
+    const int i,
+    const int j
 ){
-  const int isize = domain->mysizes[0];
-  const int jsize = domain->mysizes[1];
-  const double * restrict dxc = domain->dxc;
-  BEGIN
-    src[cnt] -= 1. / DXC(i  ) * (
-        - P(i-1, j  )
-        + P(i  , j  )
-    );
-  END
-  return 0;
+  return dxinv * (
+      - P(i-1, j  )
+      + P(i  , j  )
+  );
 }
 
-static int buoyancy(
-    const domain_t * domain,
+static inline double buoyancy(
+    const int isize,
     const double * restrict t,
-    double * restrict src
+    const int i,
+    const int j
 ){
   // buoyancy force (Boussinesq approximation)
   // NOTE: use arithmetic average, not volume average
   //   to achieve the discrete energy balance
+  return
+    + 0.5 * T(i-1, j  )
+    + 0.5 * T(i  , j  );
+}
+
+/**
+ * @brief add surface tension force to the explicit source term of ux
+ * @param[in]     domain    : information related to MPI domain decomposition
+ * @param[in]     interface : vof field and curvature
+ * @param[in,out] srcux     : explicit RK source term of ux
+ * @return                  : error code
+ */
+int surface_ux(
+    const domain_t * domain,
+    const interface_t * interface,
+    double * restrict srcux
+){
+  // continuum surface force: tension x vof gradient x averaged curvature
+  // NOTE: curvature is only stored in the narrow band,
+  //   outside which the vof gradient vanishes
+  //   and thus the surface tension force is zero
   const int isize = domain->mysizes[0];
   const int jsize = domain->mysizes[1];
-  BEGIN
-    src[cnt] +=
-      + 0.5 * T(i-1, j  )
-      + 0.5 * T(i  , j  );
-  END
+  const double * restrict dxcinv = domain->dxcinv;
+  const double tension = interface->tension;
+  const int (* restrict branges)[2] = interface->band.ranges;
+  const int * restrict boffsets = interface->band.offsets;
+  const double * restrict vof = interface->vof.data;
+  const double * restrict curv = interface->curv;
+  THREADS_PRAGMA(omp parallel for schedule(static))
+  for(int j = 1; j <= jsize; j++){
+    // faces whose both sides are in the band
+    const int is = BRANGES(j)[0] + 1 < 2     ? 2     : BRANGES(j)[0] + 1;
+    const int ie = BRANGES(j)[1]     > isize ? isize : BRANGES(j)[1]    ;
+    for(int i = is; i <= ie; i++){
+      // compute surface tension force in x direction | 10
+      const double grad = DXCINV(i  ) * (
+          - VOF(i-1, j  )
+          + VOF(i  , j  )
+      );
+      const double kappa = 0.5 * (
+          + CURV(i-1, j  )
+          + CURV(i  , j  )
+      );
+      SRCUX(i, j) += tension * grad * kappa;
+    }
+  }
   return 0;
 }
 
-static int surface(
+// fused kernel, which is specialised for uniform x grids
+//   by giving a constant "is_uniform"
+static inline int kernel(
     const domain_t * domain,
-    const double * restrict ifrc,
-    double * restrict src
+    const bool is_uniform,
+    const int is,
+    const int ie,
+    fluid_t * fluid
 ){
+  const double * restrict ux = fluid->ux.data;
+  const double * restrict uy = fluid->uy.data;
+  const double * restrict  p = fluid-> p.data;
+  const double * restrict  t = fluid-> t.data;
+  double * restrict srca = fluid->srcux[rk_a].data;
+  double * restrict srcg = fluid->srcux[rk_g].data;
+  const double diffusivity = fluid->m_dif;
   const int isize = domain->mysizes[0];
   const int jsize = domain->mysizes[1];
-  BEGIN
-    src[cnt] += ifrc[cnt];
-  END
+  const double * restrict dxcinv = domain->dxcinv;
+  const double * restrict wxm = domain->wxm;
+  const double * restrict wxp = domain->wxp;
+  // constant metric of uniform grids
+  const double dxinv = domain->dxfinv[0];
+  const double dyinv = domain->dyinv;
+  const laplacian_t * restrict lapx = laplacians.lapx;
+  const laplacian_t * restrict lapy = &laplacians.lapy;
+  const bool implicit_x = param_m_implicit_x;
+  const bool implicit_y = param_m_implicit_y;
+  const bool add_buoyancy = param_add_buoyancy;
+  const bool low_storage = param_rk_low_storage;
+  // all contributions of a cell are accumulated in registers
+  //   and are stored only once, so that the source terms
+  //   need not be zero-cleared in advance
+  // x faces in the tile, the left-most wall face is excluded
+  THREADS_PRAGMA(omp parallel for schedule(static))
+  for(int j = 1; j <= jsize; j++){
+    for(int i = 2 < is ? is : 2; i <= ie; i++){
+      // source terms, which have no halo and are accessed linearly
+      const int cnt = (isize - 1) * (j - 1) + i - 2;
+      // x metrics at this face
+      const double lxinv = is_uniform ? dxinv : DXCINV(i  );
+      const double w_xm  = is_uniform ? 0.5   : WXM(i  );
+      const double w_xp  = is_uniform ? 0.5   : WXP(i  );
+      double expl = 0.;
+      double impl = 0.;
+      // advective contributions, always explicit
+      expl += advection_x(isize, lxinv, ux, i, j);
+      expl += advection_y(isize, w_xm, w_xp, dyinv, ux, uy, i, j);
+      // diffusive contributions, can be explicit or implicit
+      const double difx = diffusion_x(isize, lapx, diffusivity, ux, i, j);
+      const double dify = diffusion_y(isize, lapy, diffusivity, ux, i, j);
+      if(implicit_x){
+        impl += difx;
+      }else{
+        expl += difx;
+      }
+      if(implicit_y){
+        impl += dify;
+      }else{
+        expl += dify;
+      }
+      // pressure-gradient contribution, always implicit
+      impl -= pressure(isize, lxinv, p, i, j);
+      // add buoyancy when spcified
+      if(add_buoyancy){
+        expl += buoyancy(isize, t, i, j);
+      }
+      srca[cnt] = expl;
+      // previous explicit terms are added in the low-storage mode
+      srcg[cnt] = low_storage ? srcg[cnt] + impl : impl;
+    }
+  }
   return 0;
 }
 
 /**
  * @brief comute right-hand-side of Runge-Kutta scheme of ux
  * @param[in]     domain : information related to MPI domain decomposition
+ * @param[in]     is, ie : range of the tile, x faces [max(is, 2) : ie] are updated
  * @param[in,out] fluid  : n-step flow field (in), RK source terms (inout)
  * @return               : error code
  */
 int compute_rhs_ux(
     const domain_t * domain,
-    fluid_t * fluid,
-    const interface_t * interface
+    const int is,
+    const int ie,
+    fluid_t * fluid
 ){
   if(!laplacians.is_initialised){
     if(0 != init_lap(domain)){
       return 1;
     }
   }
-  const double * restrict ux = fluid->ux.data;
-  const double * restrict uy = fluid->uy.data;
-  const double * restrict  p = fluid-> p.data;
-  const double * restrict  t = fluid-> t.data;
-  double * restrict srca = fluid->srcux[rk_a].data;
-  double * restrict srcg = fluid->srcux[rk_g].data;
-  const double diffusivity = fluid->m_dif;
-  // advective contributions, always explicit
-  advection_x(domain, ux,     srca);
-  advection_y(domain, ux, uy, srca);
-  // diffusive contributions, can be explicit or implicit
-  diffusion_x(domain, diffusivity, ux, param_m_implicit_x ? srcg : srca);
-  diffusion_y(domain, diffusivity, ux, param_m_implicit_y ? srcg : srca);
-  // pressure-gradient contribution, always implicit
-  pressure(domain, p, srcg);
-  // add buoyancy when spcified
-  if(param_add_buoyancy){
-    buoyancy(domain, t, srca);
+  bool x_grid_is_uniform = false;
+  domain_check_x_grid_is_uniform(domain, &x_grid_is_uniform);
+  if(x_grid_is_uniform){
+    kernel(domain, true, is, ie, fluid);
+  }else{
+    kernel(domain, false, is, ie, fluid);
   }
-  surface(domain, interface->ifrcx.data, srca);
   return 0;
 }
 
@@ -271,53 +352,39 @@ static int solve_in_x(
   return 0;
 }
 
-static int solve_in_y(
-    const double prefactor,
-    linear_system_t * linear_system
-){
-  tdm_info_t * tdm_info = linear_system->tdm_y;
-  int size = 0;
-  double * restrict tdm_l = NULL;
-  double * restrict tdm_c = NULL;
-  double * restrict tdm_u = NULL;
-  tdm.get_size(tdm_info, &size);
-  tdm.get_l(tdm_info, &tdm_l);
-  tdm.get_c(tdm_info, &tdm_c);
-  tdm.get_u(tdm_info, &tdm_u);
-  const laplacian_t * restrict lapy = &laplacians.lapy;
-  for(int j = 0; j < size; j++){
-    tdm_l[j] =    - prefactor * (*lapy)[0];
-    tdm_c[j] = 1. - prefactor * (*lapy)[1];
-    tdm_u[j] =    - prefactor * (*lapy)[2];
-  }
-  tdm.solve(tdm_info, linear_system->y1pncl);
-  return 0;
-}
-
-
 /**
- * @brief predict ux
- * @param[in]     domain : information about domain decomposition and size
- * @param[in]     rkstep : Runge-Kutta step
- * @param[in]     dt     : time step size
- * @param[in,out] fluid  : Runge-Kutta source terms (in), velocity (out)
- * @return               : error code
+ * @brief compute increment of ux, which is solved implicitly in x if needed
+ * @param[in]     domain    : information about domain decomposition and size
+ * @param[in]     rkstep    : Runge-Kutta step
+ * @param[in]     dt        : time step size
+ * @param[in,out] fluid     : Runge-Kutta source terms (in,out) and diffusivity (in)
+ * @param[out]    increment : increment in the x1 pencil, whose buffer is owned by this file
+ * @return                  : error code
  */
 int predict_ux(
     const domain_t * domain,
     const size_t rkstep,
     const double dt,
-    fluid_t * fluid
+    fluid_t * fluid,
+    double ** increment
 ){
+  // laplacians are needed by the implicit treatment,
+  //   even if the right-hand-side terms are computed elsewhere
+  if(!laplacians.is_initialised){
+    if(0 != init_lap(domain)){
+      return 1;
+    }
+  }
   static linear_system_t linear_system = {
     .is_initialised = false,
   };
   if(!linear_system.is_initialised){
     // if not initialised yet, prepare linear solver
-    //   for implicit diffusive term treatment
+    //   for implicit diffusive term treatment in x,
+    //   whereas y is treated together with the other fields
     const bool implicit[NDIMS] = {
       param_m_implicit_x,
-      param_m_implicit_y,
+      false,
     };
     const size_t glsizes[NDIMS] = {
       domain->glsizes[0] - 1,
@@ -334,16 +401,32 @@ int predict_ux(
     const double coef_g = rkcoefs[rkstep][rk_g];
     const double * restrict srcuxa = fluid->srcux[rk_a].data;
     const double * restrict srcuxb = fluid->srcux[rk_b].data;
-    const double * restrict srcuxg = fluid->srcux[rk_g].data;
+    double       * restrict srcuxg = fluid->srcux[rk_g].data;
     const int isize = domain->mysizes[0];
     const int jsize = domain->mysizes[1];
     double * restrict dux = linear_system.x1pncl;
     const size_t nitems = (isize - 1) * jsize;
-    for(size_t n = 0; n < nitems; n++){
-      dux[n] =
-        + coef_a * dt * srcuxa[n]
-        + coef_b * dt * srcuxb[n]
-        + coef_g * dt * srcuxg[n];
+    if(param_rk_low_storage){
+      // the implicit terms already contain coef_b / coef_g times
+      //   the previous explicit terms, which are replaced by
+      //   the current ones scaled for the next stage
+      const size_t next = (rkstep + 1) % 3;
+      const double fold = rkcoefs[next][rk_b] / rkcoefs[next][rk_g];
+      THREADS_PRAGMA(omp parallel for schedule(static))
+      for(size_t n = 0; n < nitems; n++){
+        dux[n] =
+          + coef_a * dt * srcuxa[n]
+          + coef_g * dt * srcuxg[n];
+        srcuxg[n] = fold * srcuxa[n];
+      }
+    }else{
+      THREADS_PRAGMA(omp parallel for schedule(static))
+      for(size_t n = 0; n < nitems; n++){
+        dux[n] =
+          + coef_a * dt * srcuxa[n]
+          + coef_b * dt * srcuxb[n]
+          + coef_g * dt * srcuxg[n];
+      }
     }
   }
   // gamma dt diffusivity / 2
@@ -356,34 +439,29 @@ int predict_ux(
         &linear_system
     );
   }
-  // solve linear systems in y
-  if(param_m_implicit_y){
-    sdecomp.transpose.execute(
-        linear_system.transposer_x1_to_y1,
-        linear_system.x1pncl,
-        linear_system.y1pncl
-    );
-    solve_in_y(
-        prefactor,
-        &linear_system
-    );
-    sdecomp.transpose.execute(
-        linear_system.transposer_y1_to_x1,
-        linear_system.y1pncl,
-        linear_system.x1pncl
-    );
-  }
-  // the field is actually updated here
-  {
-    const int isize = domain->mysizes[0];
-    const int jsize = domain->mysizes[1];
-    const double * restrict dux = linear_system.x1pncl;
-    double * restrict ux = fluid->ux.data;
-    BEGIN
-      UX(i, j) += dux[cnt];
-    END
-    fluid_update_boundaries_ux(domain, &fluid->ux);
-  }
+  *increment = linear_system.x1pncl;
+  return 0;
+}
+
+/**
+ * @brief update ux using the increment
+ * @param[in]     domain : information about domain decomposition and size
+ * @param[in]     dux    : increment in the x1 pencil
+ * @param[in,out] fluid  : velocity
+ * @return               : error code
+ */
+int update_ux(
+    const domain_t * domain,
+    const double * restrict dux,
+    fluid_t * fluid
+){
+  const int isize = domain->mysizes[0];
+  const int jsize = domain->mysizes[1];
+  double * restrict ux = fluid->ux.data;
+  BEGIN
+    UX(i, j) += dux[cnt];
+  END
+  fluid_update_boundaries_ux(domain, &fluid->ux);
   return 0;
 }
 
@@ -8,12 +8,18 @@
 #include "fluid_solver.h"
 #include "interface.h"
 #include "interface_solver.h"
+#include "threads.h"
 #include "internal.h"
 #include "array_macros/domain/dxf.h"
 #include "array_macros/domain/dxc.h"
+#include "array_macros/domain/dxfinv.h"
 #include "array_macros/fluid/ux.h"
 #include "array_macros/fluid/uy.h"
 #include "array_macros/fluid/p.h"
+#include "array_macros/fluid/srcuy.h"
+#include "array_macros/interface/vof.h"
+#include "array_macros/interface/band.h"
+#include "array_macros/interface/curv.h"
 
 // store approximation of laplacian
 typedef double laplacian_t[3];
@@ -61,162 +67,235 @@ static int init_lap(
 }
 
 #define BEGIN \
-  for(int cnt = 0, j = 1; j <= jsize; j++){ \
-    for(int i = 1; i <= isize; i++, cnt++){
+  THREADS_PRAGMA(omp parallel for schedule(static)) \
+  for(int j = 1; j <= jsize; j++){ \
+    for(int i = 1; i <= isize; i++){ \
+      const int cnt = isize * (j - 1) + (i - 1);
 #define END \
     } \
   }
 
-static int advection_x(
-    const domain_t * domain,
+// contributions to the right-hand-side of a single cell,
+//   which are combined by the fused kernel below
+
+static inline double advection_x(
+    const int isize,
+    const double dxinv,
     const double * restrict uy,
     const double * restrict ux,
-    double * restrict src
+    const int i,
+    const int j
 ){
-  const int isize = domain->mysizes[0];
-  const int jsize = domain->mysizes[1];
-  const double * restrict dxf = domain->dxf;
-  BEGIN
-    // uy is transported by ux
-    const double ux_l = + 0.5 * UX(i  , j-1) + 0.5 * UX(i  , j  );
-    const double ux_u = + 0.5 * UX(i+1, j-1) + 0.5 * UX(i+1, j  );
-    const double l = + 0.5 / DXF(i  ) * ux_l;
-    const double u = - 0.5 / DXF(i  ) * ux_u;
-    const double c = - l - u;
-    src[cnt] +=
-      + l * UY(i-1, j  )
-      + c * UY(i  , j  )
-      + u * UY(i+1, j  );
-  END
-  return 0;
+  // uy is transported by ux
+  const double ux_l = + 0.5 * UX(i  , j-1) + 0.5 * UX(i  , j  );
+  const double ux_u = + 0.5 * UX(i+1, j-1) + 0.5 * UX(i+1, j  );
+  const double l = + 0.5 * dxinv * ux_l;
+  const double u = - 0.5 * dxinv * ux_u;
+  const double c = - l - u;
+  return
+    + l * UY(i-1, j  )
+    + c * UY(i  , j  )
+    + u * UY(i+1, j  );
 }
 
-static int advection_y(
-    const domain_t * domain,
+static inline double advection_y(
+    const int isize,
+    const double dyinv,
     const double * restrict uy,
-    double * restrict src
+    const int i,
+    const int j
 ){
-  const int isize = domain->mysizes[0];
-  const int jsize = domain->mysizes[1];
-  const double dy = domain->dy;
-  BEGIN
-    // uy is transported by uy
-    const double uy_l = + 0.5 * UY(i  , j-1) + 0.5 * UY(i  , j  );
-    const double uy_u = + 0.5 * UY(i  , j  ) + 0.5 * UY(i  , j+1);
-    const double l = + 0.5 / dy * uy_l;
-    const double u = - 0.5 / dy * uy_u;
-    const double c = - l - u;
-    src[cnt] +=
-      + l * UY(i  , j-1)
-      + c * UY(i  , j  )
-      + u * UY(i  , j+1);
-  END
-  return 0;
+  // uy is transported by uy
+  const double uy_l = + 0.5 * UY(i  , j-1) + 0.5 * UY(i  , j  );
+  const double uy_u = + 0.5 * UY(i  , j  ) + 0.5 * UY(i  , j+1);
+  const double l = + 0.5 * dyinv * uy_l;
+  const double u = - 0.5 * dyinv * uy_u;
+  const double c = - l - u;
+  return
+    + l * UY(i  , j-1)
+    + c * UY(i  , j  )
+    + u * UY(i  , j+1);
 }
 
-
-static int diffusion_x(
-    const domain_t * domain,
+static inline double diffusion_x(
+    const int isize,
+    const laplacian_t * restrict lapx,
     const double diffusivity,
     const double * restrict uy,
-    double * restrict src
+    const int i,
+    const int j
 ){
-  const int isize = domain->mysizes[0];
-  const int jsize = domain->mysizes[1];
-  const laplacian_t * restrict lapx = laplacians.lapx;
-  BEGIN
-    // uy is diffused in x
-    src[cnt] += diffusivity * (
-        + LAPX(i)[0] * UY(i-1, j  )
-        + LAPX(i)[1] * UY(i  , j  )
-        + LAPX(i)[2] * UY(i+1, j  )
-    );
-  END
-  return 0;
+  // uy is diffused in x
+  return diffusivity * (
+      + LAPX(i)[0] * UY(i-1, j  )
+      + LAPX(i)[1] * UY(i  , j  )
+      + LAPX(i)[2] * UY(i+1, j  )
+  );
 }
 
-static int diffusion_y(
-    const domain_t * domain,
+static inline double diffusion_y(
+    const int isize,
+    const laplacian_t * restrict lapy,
     const double diffusivity,
     const double * restrict uy,
-    double * restrict src
+    const int i,
+    const int j
 ){
-  const int isize = domain->mysizes[0];
-  const int jsize = domain->mysizes[1];
-  const laplacian_t * restrict lapy = &laplacians.lapy;
-  BEGIN
-    // uy is diffused in y
-    src[cnt] += diffusivity * (
-        + (*lapy)[0] * UY(i  , j-1)
-        + (*lapy)[1] * UY(i  , j  )
-        + (*lapy)[2] * UY(i  , j+1)
-    );
-  END
-  return 0;
+  // uy is diffused in y
+  return diffusivity * (
+      + (*lapy)[0] * UY(i  , j-1)
+      + (*lapy)[1] * UY(i  , j  )
+      + (*lapy)[2] * UY(i  , j+1)
+  );
 }
 
+static inline double pressure(
+    const int isize,
+    const double dyinv,
+    const double * restrict p,
+    const int i,
+    const int j
+){
+  return dyinv * (
+      - P(i  , j-1)
+      + P(i  , j  )
+  );
+}
 
-static int pressure(
+/**
+ * @brief add surface tension force to the explicit source term of uy
+ * @param[in]     domain    : information related to MPI domain decomposition
+ * @param[in]     interface : vof field and curvature
+ * @param[in,out] srcuy     : explicit RK source term of uy
+ * @return                  : error code
+ */
+int surface_uy(
     const domain_t * domain,
-    const double * restrict p,
-    double * restrict src
+    const interface_t * interface,
+    double * restrict srcuy
 ){
+  // continuum surface force: tension x vof gradient x averaged curvature
+  // NOTE: curvature is only stored in the narrow band,
+  //   outside which the vof gradient vanishes
+  //   and thus the surface tension force is zero
   const int isize = domain->mysizes[0];
   const int jsize = domain->mysizes[1];
-  const double dy = domain->dy;
-  BEGIN
-    src[cnt] -= 1. / dy * (
-        - P(i  , j-1)
-        + P(i  , j  )
-    );
-  END
+  const double dyinv = domain->dyinv;
+  const double tension = interface->tension;
+  const int (* restrict branges)[2] = interface->band.ranges;
+  const int * restrict boffsets = interface->band.offsets;
+  const double * restrict vof = interface->vof.data;
+  const double * restrict curv = interface->curv;
+  THREADS_PRAGMA(omp parallel for schedule(static))
+  for(int j = 1; j <= jsize; j++){
+    // faces whose both sides are in the band
+    const int is = BRANGES(j-1)[0] > BRANGES(j  )[0] ? BRANGES(j-1)[0] : BRANGES(j  )[0];
+    const int ie = BRANGES(j-1)[1] < BRANGES(j  )[1] ? BRANGES(j-1)[1] : BRANGES(j  )[1];
+    for(int i = is; i <= ie; i++){
+      // compute surface tension force in y direction | 9
+      const double grad = dyinv * (
+          - VOF(i  , j-1)
+          + VOF(i  , j  )
+      );
+      const double kappa = 0.5 * (
+          + CURV(i  , j-1)
+          + CURV(i  , j  )
+      );
+      SRCUY(i, j) += tension * grad * kappa;
+    }
+  }
   return 0;
 }
 
-static int surface(
+// fused kernel, which is specialised for uniform x grids
+//   by giving a constant "is_uniform"
+static inline int kernel(
     const domain_t * domain,
-    const double * restrict ifrc,
-    double * restrict src
+    const bool is_uniform,
+    const int is,
+    const int ie,
+    fluid_t * fluid
 ){
+  const double * restrict ux = fluid->ux.data;
+  const double * restrict uy = fluid->uy.data;
+  const double * restrict  p = fluid-> p.data;
+  double * restrict srca = fluid->srcuy[rk_a].data;
+  double * restrict srcg = fluid->srcuy[rk_g].data;
+  const double diffusivity = fluid->m_dif;
   const int isize = domain->mysizes[0];
   const int jsize = domain->mysizes[1];
-  BEGIN
-    src[cnt] += ifrc[cnt];
-  END
+  const double * restrict dxfinv = domain->dxfinv;
+  // constant metric of uniform grids
+  const double dxinv = domain->dxfinv[0];
+  const double dyinv = domain->dyinv;
+  const laplacian_t * restrict lapx = laplacians.lapx;
+  const laplacian_t * restrict lapy = &laplacians.lapy;
+  const bool implicit_x = param_m_implicit_x;
+  const bool implicit_y = param_m_implicit_y;
+  const bool low_storage = param_rk_low_storage;
+  // all contributions of a cell are accumulated in registers
+  //   and are stored only once, so that the source terms
+  //   need not be zero-cleared in advance
+  THREADS_PRAGMA(omp parallel for schedule(static))
+  for(int j = 1; j <= jsize; j++){
+    for(int i = is; i <= ie; i++){
+      // source terms, which have no halo and are accessed linearly
+      const int cnt = isize * (j - 1) + i - 1;
+      // x metric at this cell
+      const double lxinv = is_uniform ? dxinv : DXFINV(i  );
+      double expl = 0.;
+      double impl = 0.;
+      // advective contributions, always explicit
+      expl += advection_x(isize, lxinv, uy, ux, i, j);
+      expl += advection_y(isize, dyinv, uy, i, j);
+      // diffusive contributions, can be explicit or implicit
+      const double difx = diffusion_x(isize, lapx, diffusivity, uy, i, j);
+      const double dify = diffusion_y(isize, lapy, diffusivity, uy, i, j);
+      if(implicit_x){
+        impl += difx;
+      }else{
+        expl += difx;
+      }
+      if(implicit_y){
+        impl += dify;
+      }else{
+        expl += dify;
+      }
+      // pressure-gradient contribution, always implicit
+      impl -= pressure(isize, dyinv, p, i, j);
+      srca[cnt] = expl;
+      // previous explicit terms are added in the low-storage mode
+      srcg[cnt] = low_storage ? srcg[cnt] + impl : impl;
+    }
+  }
   return 0;
 }
 
 /**
  * @brief comute right-hand-side of Runge-Kutta scheme of uy
  * @param[in]     domain : information related to MPI domain decomposition
+ * @param[in]     is, ie : range of the tile, cells [is : ie] are updated
  * @param[in,out] fluid  : n-step flow field (in), RK source terms (inout)
  * @return               : error code
  */
 int compute_rhs_uy(
     const domain_t * domain,
-    fluid_t * fluid,
-    const interface_t * interface
+    const int is,
+    const int ie,
+    fluid_t * fluid
 ){
   if(!laplacians.is_initialised){
     if(0 != init_lap(domain)){
       return 1;
     }
   }
-  const double * restrict ux = fluid->ux.data;
-  const double * restrict uy = fluid->uy.data;
-  const double * restrict  p = fluid-> p.data;
-  double * restrict srca = fluid->srcuy[rk_a].data;
-  double * restrict srcg = fluid->srcuy[rk_g].data;
-  const double diffusivity = fluid->m_dif;
-  // advective contributions, always explicit
-  advection_x(domain, uy, ux, srca);
-  advection_y(domain, uy,     srca);
-  // diffusive contributions, can be explicit or implicit
-  diffusion_x(domain, diffusivity, uy, param_m_implicit_x ? srcg : srca);
-  diffusion_y(domain, diffusivity, uy, param_m_implicit_y ? srcg : srca);
-  // pressure-gradient contribution, always implicit
-  pressure(domain, p, srcg);
-  surface(domain, interface->ifrcy.data, srca);
+  bool x_grid_is_uniform = false;
+  domain_check_x_grid_is_uniform(domain, &x_grid_is_uniform);
+  if(x_grid_is_uniform){
+    kernel(domain, true, is, ie, fluid);
+  }else{
+    kernel(domain, false, is, ie, fluid);
+  }
   return 0;
 }
 
@@ -243,53 +322,39 @@ static int solve_in_x(
   return 0;
 }
 
-static int solve_in_y(
-    const double prefactor,
-    linear_system_t * linear_system
-){
-  tdm_info_t * tdm_info = linear_system->tdm_y;
-  int size = 0;
-  double * restrict tdm_l = NULL;
-  double * restrict tdm_c = NULL;
-  double * restrict tdm_u = NULL;
-  tdm.get_size(tdm_info, &size);
-  tdm.get_l(tdm_info, &tdm_l);
-  tdm.get_c(tdm_info, &tdm_c);
-  tdm.get_u(tdm_info, &tdm_u);
-  const laplacian_t * restrict lapy = &laplacians.lapy;
-  for(int j = 0; j < size; j++){
-    tdm_l[j] =    - prefactor * (*lapy)[0];
-    tdm_c[j] = 1. - prefactor * (*lapy)[1];
-    tdm_u[j] =    - prefactor * (*lapy)[2];
-  }
-  tdm.solve(tdm_info, linear_system->y1pncl);
-  return 0;
-}
-
-
 /**
- * @brief predict uy
- * @param[in]     domain : information about domain decomposition and size
- * @param[in]     rkstep : Runge-Kutta step
- * @param[in]     dt     : time step size
- * @param[in,out] fluid  : Runge-Kutta source terms (in), velocity (out)
- * @return               : error code
+ * @brief compute increment of uy, which is solved implicitly in x if needed
+ * @param[in]     domain    : information about domain decomposition and size
+ * @param[in]     rkstep    : Runge-Kutta step
+ * @param[in]     dt        : time step size
+ * @param[in,out] fluid     : Runge-Kutta source terms (in,out) and diffusivity (in)
+ * @param[out]    increment : increment in the x1 pencil, whose buffer is owned by this file
+ * @return                  : error code
  */
 int predict_uy(
     const domain_t * domain,
     const size_t rkstep,
     const double dt,
-    fluid_t * fluid
+    fluid_t * fluid,
+    double ** increment
 ){
+  // laplacians are needed by the implicit treatment,
+  //   even if the right-hand-side terms are computed elsewhere
+  if(!laplacians.is_initialised){
+    if(0 != init_lap(domain)){
+      return 1;
+    }
+  }
   static linear_system_t linear_system = {
     .is_initialised = false,
   };
   if(!linear_system.is_initialised){
     // if not initialised yet, prepare linear solver
-    //   for implicit diffusive term treatment
+    //   for implicit diffusive term treatment in x,
+    //   whereas y is treated together with the other fields
     const bool implicit[NDIMS] = {
       param_m_implicit_x,
-      param_m_implicit_y,
+      false,
     };
     const size_t glsizes[NDIMS] = {
       domain->glsizes[0],
@@ -306,16 +371,32 @@ int predict_uy(
     const double coef_g = rkcoefs[rkstep][rk_g];
     const double * restrict srcuya = fluid->srcuy[rk_a].data;
     const double * restrict srcuyb = fluid->srcuy[rk_b].data;
-    const double * restrict srcuyg = fluid->srcuy[rk_g].data;
+    double       * restrict srcuyg = fluid->srcuy[rk_g].data;
     const int isize = domain->mysizes[0];
     const int jsize = domain->mysizes[1];
     double * restrict duy = linear_system.x1pncl;
     const size_t nitems = isize * jsize;
-    for(size_t n = 0; n < nitems; n++){
-      duy[n] =
-        + coef_a * dt * srcuya[n]
-        + coef_b * dt * srcuyb[n]
-        + coef_g * dt * srcuyg[n];
+    if(param_rk_low_storage){
+      // the implicit terms already contain coef_b / coef_g times
+      //   the previous explicit terms, which are replaced by
+      //   the current ones scaled for the next stage
+      const size_t next = (rkstep + 1) % 3;
+      const double fold = rkcoefs[next][rk_b] / rkcoefs[next][rk_g];
+      THREADS_PRAGMA(omp parallel for schedule(static))
+      for(size_t n = 0; n < nitems; n++){
+        duy[n] =
+          + coef_a * dt * srcuya[n]
+          + coef_g * dt * srcuyg[n];
+        srcuyg[n] = fold * srcuya[n];
+      }
+    }else{
+      THREADS_PRAGMA(omp parallel for schedule(static))
+      for(size_t n = 0; n < nitems; n++){
+        duy[n] =
+          + coef_a * dt * srcuya[n]
+          + coef_b * dt * srcuyb[n]
+          + coef_g * dt * srcuyg[n];
+      }
     }
   }
   // gamma dt diffusivity / 2
@@ -328,34 +409,29 @@ int predict_uy(
         &linear_system
     );
   }
-  // solve linear systems in y
-  if(param_m_implicit_y){
-    sdecomp.transpose.execute(
-        linear_system.transposer_x1_to_y1,
-        linear_system.x1pncl,
-        linear_system.y1pncl
-    );
-    solve_in_y(
-        prefactor,
-        &linear_system
-    );
-    sdecomp.transpose.execute(
-        linear_system.transposer_y1_to_x1,
-        linear_system.y1pncl,
-        linear_system.x1pncl
-    );
-  }
-  // the field is actually updated here
-  {
-    const int isize = domain->mysizes[0];
-    const int jsize = domain->mysizes[1];
-    const double * restrict duy = linear_system.x1pncl;
-    double * restrict uy = fluid->uy.data;
-    BEGIN
-      UY(i, j) += duy[cnt];
-    END
-    fluid_update_boundaries_uy(domain, &fluid->uy);
-  }
+  *increment = linear_system.x1pncl;
+  return 0;
+}
+
+/**
+ * @brief update uy using the increment
+ * @param[in]     domain : information about domain decomposition and size
+ * @param[in]     duy    : increment in the x1 pencil
+ * @param[in,out] fluid  : velocity
+ * @return               : error code
+ */
+int update_uy(
+    const domain_t * domain,
+    const double * restrict duy,
+    fluid_t * fluid
+){
+  const int isize = domain->mysizes[0];
+  const int jsize = domain->mysizes[1];
+  double * restrict uy = fluid->uy.data;
+  BEGIN
+    UY(i, j) += duy[cnt];
+  END
+  fluid_update_boundaries_uy(domain, &fluid->uy);
   return 0;
 }
 
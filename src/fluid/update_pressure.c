@@ -1,24 +1,29 @@
 #include "param.h"
 #include "runge_kutta.h"
 #include "memory.h"
+#include "tiling.h"
 #include "domain.h"
 #include "fluid.h"
 #include "fluid_solver.h"
-#include "array_macros/domain/dxf.h"
-#include "array_macros/domain/dxc.h"
+#include "threads.h"
+#include "array_macros/domain/dxfinv.h"
+#include "array_macros/domain/dxcinv.h"
 #include "array_macros/fluid/p.h"
 #include "array_macros/fluid/psi.h"
 
 static inline int add_explicit(
     const domain_t * domain,
+    const int is,
+    const int ie,
     const fluid_t * fluid
 ){
   const int isize = domain->mysizes[0];
   const int jsize = domain->mysizes[1];
   const double * restrict psi = fluid->psi.data;
   double * restrict p = fluid->p.data;
+  THREADS_PRAGMA(omp parallel for schedule(static))
   for(int j = 1; j <= jsize; j++){
-    for(int i = 1; i <= isize; i++){
+    for(int i = is; i <= ie; i++){
       // explicit contribution
       P(i, j) += PSI(i, j);
     }
@@ -26,23 +31,36 @@ static inline int add_explicit(
   return 0;
 }
 
+// specialised for uniform x grids by giving a constant "is_uniform"
+// NOTE: the half-cell distances at the walls are replaced as well,
+//   which is harmless since psi satisfies the Neumann condition
+//   and thus the gradients there vanish
 static inline int add_implicit_x(
     const domain_t * domain,
+    const bool is_uniform,
     const double prefactor,
+    const int is,
+    const int ie,
     fluid_t * fluid
 ){
   const int isize = domain->mysizes[0];
   const int jsize = domain->mysizes[1];
-  const double * restrict dxf = domain->dxf;
-  const double * restrict dxc = domain->dxc;
+  const double * restrict dxfinv = domain->dxfinv;
+  const double * restrict dxcinv = domain->dxcinv;
+  // constant metric of uniform grids
+  const double dxinv = domain->dxfinv[0];
   const double * restrict psi = fluid->psi.data;
   double * restrict p = fluid->p.data;
+  THREADS_PRAGMA(omp parallel for schedule(static))
   for(int j = 1; j <= jsize; j++){
-    for(int i = 1; i <= isize; i++){
+    for(int i = is; i <= ie; i++){
       // x implicit contribution
-      const double dpsidx_xm = (- PSI(i-1, j  ) + PSI(i  , j  )) / DXC(i  );
-      const double dpsidx_xp = (- PSI(i  , j  ) + PSI(i+1, j  )) / DXC(i+1);
-      P(i, j) -= prefactor / DXF(i  ) * (
+      const double dxcinv_xm = is_uniform ? dxinv : DXCINV(i  );
+      const double dxcinv_xp = is_uniform ? dxinv : DXCINV(i+1);
+      const double dxfinv_x0 = is_uniform ? dxinv : DXFINV(i  );
+      const double dpsidx_xm = (- PSI(i-1, j  ) + PSI(i  , j  )) * dxcinv_xm;
+      const double dpsidx_xp = (- PSI(i  , j  ) + PSI(i+1, j  )) * dxcinv_xp;
+      P(i, j) -= prefactor * dxfinv_x0 * (
           - dpsidx_xm
           + dpsidx_xp
       );
@@ -54,19 +72,22 @@ static inline int add_implicit_x(
 static inline int add_implicit_y(
     const domain_t * domain,
     const double prefactor,
+    const int is,
+    const int ie,
     fluid_t * fluid
 ){
   const int isize = domain->mysizes[0];
   const int jsize = domain->mysizes[1];
-  const double dy = domain->dy;
+  const double dyinv = domain->dyinv;
   const double * restrict psi = fluid->psi.data;
   double * restrict p = fluid->p.data;
+  THREADS_PRAGMA(omp parallel for schedule(static))
   for(int j = 1; j <= jsize; j++){
-    for(int i = 1; i <= isize; i++){
+    for(int i = is; i <= ie; i++){
       // y implicit contribution
-      const double dpsidy_ym = (- PSI(i  , j-1) + PSI(i  , j  )) / dy;
-      const double dpsidy_yp = (- PSI(i  , j  ) + PSI(i  , j+1)) / dy;
-      P(i, j) -= prefactor / dy * (
+      const double dpsidy_ym = (- PSI(i  , j-1) + PSI(i  , j  )) * dyinv;
+      const double dpsidy_yp = (- PSI(i  , j  ) + PSI(i  , j+1)) * dyinv;
+      P(i, j) -= prefactor * dyinv * (
           - dpsidy_ym
           + dpsidy_yp
       );
@@ -90,19 +111,39 @@ int fluid_update_pressure(
     const double dt,
     fluid_t * fluid
 ){
-  // explicit contribution, always present
-  add_explicit(domain, fluid);
+  static tiling_t tiling = {
+    .name = "fluid_update_pressure",
+    .is_initialised = false,
+  };
   // gamma dt diffusivity / 2
   const double prefactor =
     0.5 * rkcoefs[rkstep][rk_g] * dt * fluid->m_dif;
-  // additional corrections if diffusive terms
-  //   in the direction is treated implicitly
-  if(param_m_implicit_x){
-    add_implicit_x(domain, prefactor, fluid);
+  bool x_grid_is_uniform = false;
+  domain_check_x_grid_is_uniform(domain, &x_grid_is_uniform);
+  const int isize = domain->mysizes[0];
+  int size = isize;
+  if(0 != tiling_begin(domain, &tiling, &size)){
+    return 1;
   }
-  if(param_m_implicit_y){
-    add_implicit_y(domain, prefactor, fluid);
+  // all contributions are added tile by tile
+  for(int is = 1; is <= isize; is += size){
+    const int ie = is + size - 1 < isize ? is + size - 1 : isize;
+    // explicit contribution, always present
+    add_explicit(domain, is, ie, fluid);
+    // additional corrections if diffusive terms
+    //   in the direction is treated implicitly
+    if(param_m_implicit_x){
+      if(x_grid_is_uniform){
+        add_implicit_x(domain, true, prefactor, is, ie, fluid);
+      }else{
+        add_implicit_x(domain, false, prefactor, is, ie, fluid);
+      }
+    }
+    if(param_m_implicit_y){
+      add_implicit_y(domain, prefactor, is, ie, fluid);
+    }
   }
+  tiling_end(domain, &tiling);
   // impose boundary conditions and communicate halo cells
   fluid_update_boundaries_p(domain, &fluid->p);
   return 0;
@@ -1,4 +1,7 @@
+#include <stdio.h>
 #include <stdbool.h>
+#include "param.h"
+#include "config.h"
 #include "runge_kutta.h"
 #include "domain.h"
 #include "fluid.h"
@@ -7,6 +10,34 @@
 #include "interface_solver.h"
 #include "integrate.h"
 
+// Poisson solvers selected by the user
+enum {
+  POISSON_FFT       = 0,
+  POISSON_MULTIGRID = 1,
+};
+
+static int load_poisson_solver(
+    int * solver
+){
+  // loaded once and kept
+  static bool is_loaded = false;
+  static int value = POISSON_FFT;
+  if(!is_loaded){
+    double dvalue = 0.;
+    if(0 != config.get_double("poisson_solver", &dvalue)){
+      return 1;
+    }
+    value = (int)dvalue;
+    if(POISSON_FFT != value && POISSON_MULTIGRID != value){
+      printf("poisson_solver should be 0 (FFT) or 1 (multigrid): %d\n", value);
+      return 1;
+    }
+    is_loaded = true;
+  }
+  *solver = value;
+  return 0;
+}
+
 // integrate the equations for one time step
 int integrate(
     const domain_t * domain,
@@ -20,33 +51,59 @@ int integrate(
   //   otherwise a versatile version is adopted
   bool x_grid_is_uniform = false;
   domain_check_x_grid_is_uniform(domain, &x_grid_is_uniform);
+  // alternatively multigrid, which avoids the all-to-all transposes
+  //   since mainly neighbouring processes communicate
+  int poisson_solver = POISSON_FFT;
+  if(0 != load_poisson_solver(&poisson_solver)){
+    return 1;
+  }
   // decide time step size
   if(0 != fluid_decide_dt(domain, fluid, dt)){
     return 1;
   }
+  // when vof is advected once per step,
+  //   interface is frozen during the Runge-Kutta iterations
+  if(param_interface_once_per_step){
+    if(0 != interface_compute_curvature_tensor(domain, interface)){
+      return 1;
+    }
+    if(0 != interface_store_velocity(fluid, interface)){
+      return 1;
+    }
+  }
   // Runge-Kutta iterations
   // max iteration, should be three
   const size_t rkstepmax = sizeof(rkcoefs) / sizeof(rkcoef_t);
   for(size_t rkstep = 0; rkstep < rkstepmax; rkstep++){
-    // update vof field
-    if(0 != interface_compute_curvature_tensor(domain, interface)){
-      return 1;
+    if(!param_interface_once_per_step){
+      if(0 != interface_compute_curvature_tensor(domain, interface)){
+        return 1;
+      }
     }
-    if(0 != interface_compute_force(domain, interface)){
+    // compute right-hand-side terms of the flow field,
+    //   including the surface tension force from the current vof field
+    if(0 != fluid_compute_rhs(domain, rkstep, fluid, interface)){
       return 1;
     }
-    if(0 != interface_update_vof(domain, rkstep, *dt, fluid, interface)){
-      return 1;
+    // update vof field
+    if(!param_interface_once_per_step){
+      if(0 != interface_update_vof(domain, rkstep, *dt, fluid, interface)){
+        return 1;
+      }
     }
     // predict flow field
-    if(0 != fluid_predict_field(domain, rkstep, *dt, fluid, interface)){
+    if(0 != fluid_predict_field(domain, rkstep, *dt, fluid)){
       return 1;
     }
     // now the temperature field has been updated,
     //   while the velocity field is not divergence free
     //   and thus the following correction step is needed
     // compute scalar potential
-    if(x_grid_is_uniform){
+    if(POISSON_MULTIGRID == poisson_solver){
+      if(0 != fluid_compute_potential_mg(domain, rkstep, *dt, fluid)){
+        return 1;
+      }
+    }else if(x_grid_is_uniform){
       if(0 != fluid_compute_potential_dct(domain, rkstep, *dt, fluid)){
         return 1;
       }
@@ -64,6 +121,12 @@ int integrate(
       return 1;
     }
   }
+  // advect vof field using velocity averaged over the step
+  if(param_interface_once_per_step){
+    if(0 != interface_update_vof_once(domain, *dt, fluid, interface)){
+      return 1;
+    }
+  }
   return 0;
 }
 
@@ -0,0 +1,114 @@
+#include <stdbool.h>
+#include "memory.h"
+#include "domain.h"
+#include "interface.h"
+#include "threads.h"
+#include "internal.h"
+#include "array_macros/interface/vof.h"
+#include "array_macros/interface/band.h"
+
+static inline bool is_mixed(
+    const double lvof
+){
+  return vofmin <= lvof && lvof <= 1. - vofmin;
+}
+
+static inline bool is_active(
+    const int isize,
+    const double * restrict vof,
+    const int i,
+    const int j
+){
+  // interfacial cells, whose interface is reconstructed
+  const double lvof = VOF(i, j);
+  if(is_mixed(lvof)){
+    return true;
+  }
+  // cells whose corner gradients are non-zero,
+  //   i.e. the curvature can be non-zero
+  for(int jj = j - 1; jj <= j + 1; jj++){
+    for(int ii = i - 1; ii <= i + 1; ii++){
+      if(lvof != VOF(ii, jj)){
+        return true;
+      }
+    }
+  }
+  return false;
+}
+
+static int reserve(
+    const size_t nitems,
+    interface_t * interface
+){
+  band_t * band = &interface->band;
+  if(nitems <= band->capacity){
+    return 0;
+  }
+  // band-packed quantities are recomputed every time,
+  //   and thus previous values are not kept
+  size_t capacity = 0 == band->capacity ? 1 : band->capacity;
+  while(capacity < nitems){
+    capacity *= 2;
+  }
+  for(size_t n = 0; n < NDIMS + 1; n++){
+    memory_free(interface->normal[n]);
+  }
+  memory_free(interface->curv);
+  memory_free(interface->thinc);
+  for(size_t n = 0; n < NDIMS + 1; n++){
+    interface->normal[n] = memory_calloc(capacity, sizeof(double));
+  }
+  interface->curv   = memory_calloc(capacity, sizeof(double));
+  interface->thinc  = memory_calloc(capacity, sizeof(thinc_t));
+  band->capacity = capacity;
+  return 0;
+}
+
+/**
+ * @brief find interfacial cells and their stencil neighbours
+ * @param[in]     domain    : information about domain decomposition and size
+ * @param[in,out] interface : vof field (in), narrow band (out)
+ * @return                  : error code
+ */
+int interface_compute_band(
+    const domain_t * domain,
+    interface_t * interface
+){
+  band_t * band = &interface->band;
+  const int isize = domain->mysizes[0];
+  const int jsize = domain->mysizes[1];
+  const double * restrict vof = interface->vof.data;
+  int (* restrict branges)[2] = band->ranges;
+  int * restrict boffsets = band->offsets;
+  THREADS_PRAGMA(omp parallel for schedule(static))
+  for(int j = 0; j <= jsize + 1; j++){
+    // find the first and the last active cells in this row,
+    //   cells in between are also included for simplicity
+    int is = isize + 1;
+    int ie = isize;
+    for(int i = 1; i <= isize; i++){
+      if(is_active(isize, vof, i, j)){
+        is = i;
+        ie = i;
+        break;
+      }
+    }
+    for(int i = isize; i > is; i--){
+      if(is_active(isize, vof, i, j)){
+        ie = i;
+        break;
+      }
+    }
+    BRANGES(j)[0] = is;
+    BRANGES(j)[1] = ie;
+  }
+  // offsets of the rows in the band-packed buffers
+  int nitems = 0;
+  for(int j = 0; j <= jsize + 1; j++){
+    BOFFSETS(j) = nitems;
+    nitems += BRANGES(j)[1] - BRANGES(j)[0] + 1;
+  }
+  band->nitems = nitems;
+  return reserve(nitems, interface);
+}
+
@@ -1,73 +1,104 @@
 #include <math.h>
 #include <float.h>
+#include <stdbool.h>
 #include "param.h"
 #include "domain.h"
 #include "interface.h"
+#include "threads.h"
 #include "internal.h"
-#include "array_macros/domain/dxf.h"
-#include "array_macros/domain/dxc.h"
+#include "array_macros/domain/dxfinv.h"
+#include "array_macros/domain/dxcinv.h"
 #include "array_macros/interface/vof.h"
-#include "array_macros/interface/dvof.h"
+#include "array_macros/interface/band.h"
 #include "array_macros/interface/normal.h"
+#include "array_macros/interface/thinc.h"
 #include "array_macros/interface/curv.h"
+#include "array_macros/interface/dcache.h"
 
+static inline int imin(
+    const int a,
+    const int b
+){
+  return a < b ? a : b;
+}
+
+static inline int imax(
+    const int a,
+    const int b
+){
+  return a > b ? a : b;
+}
+
+// compute normals at the corners of a row,
+//   whose components are stored separately in "dvof"
+//   and are indexed by the corner index minus one
+// NOTE: not specialised for uniform grids,
+//   since the wall corners refer to the half-cell distances
 static int compute_gradient(
     const domain_t * domain,
-    interface_t * interface
+    const interface_t * interface,
+    const int j,
+    double * const dvof[NDIMS]
 ){
   const int isize = domain->mysizes[0];
   const int jsize = domain->mysizes[1];
-  const double * restrict dxc = domain->dxc;
-  const double            dy  = domain->dy;
+  const double * restrict dxcinv = domain->dxcinv;
+  const double            dyinv  = domain->dyinv;
+  const int (* restrict branges)[2] = interface->band.ranges;
   const double * restrict vof = interface->vof.data;
-  vector_t * restrict dvof = interface->dvof.data;
-  for(int j = 0; j <= jsize + 2; j++){
-    for(int i = 1; i <= isize + 1; i++){
-      // x gradient | 5
-      const double dx = DXC(i  );
-      const double dvofdx = 1. / dx * (
-          - VOF(i-1, j-1) + VOF(i  , j-1)
-          - VOF(i-1, j  ) + VOF(i  , j  )
-      );
-      // y gradient | 4
-      const double dvofdy = 1. / dy * (
-          - VOF(i-1, j-1) - VOF(i  , j-1)
-          + VOF(i-1, j  ) + VOF(i  , j  )
-      );
-      // normalise and obtain corner normals | 7
-      const double norm = sqrt(
-          + pow(dvofdx, 2.)
-          + pow(dvofdy, 2.)
-      );
-      const double norminv = 1. / fmax(norm, DBL_EPSILON);
-      DVOF(i, j)[0] = dvofdx * norminv;
-      DVOF(i, j)[1] = dvofdy * norminv;
+  double * restrict dvofx = dvof[0];
+  double * restrict dvofy = dvof[1];
+  // corners referred by the cells in the band,
+  //   which are the upper ones of the row j-1
+  //   and the lower ones of the row j
+  int is = isize + 1;
+  int ie = 0;
+  for(int jj = j - 1; jj <= j; jj++){
+    if(jj < 0 || jsize + 1 < jj){
+      continue;
     }
+    if(BRANGES(jj)[0] <= BRANGES(jj)[1]){
+      is = imin(is, BRANGES(jj)[0]);
+      ie = imax(ie, BRANGES(jj)[1]);
+    }
+  }
+  for(int i = is; i <= ie + 1; i++){
+    // x gradient | 5
+    const double dvofdx = DXCINV(i  ) * (
+        - VOF(i-1, j-1) + VOF(i  , j-1)
+        - VOF(i-1, j  ) + VOF(i  , j  )
+    );
+    // y gradient | 4
+    const double dvofdy = dyinv * (
+        - VOF(i-1, j-1) - VOF(i  , j-1)
+        + VOF(i-1, j  ) + VOF(i  , j  )
+    );
+    // normalise and obtain corner normals | 7
+    const double norm = sqrt(
+        + pow(dvofdx, 2.)
+        + pow(dvofdy, 2.)
+    );
+    // N.B. fmax is not used, which prevents vectorisation
+    const double norminv = 1. / (DBL_EPSILON < norm ? norm : DBL_EPSILON);
+    dvofx[i - 1] = dvofdx * norminv;
+    dvofy[i - 1] = dvofdy * norminv;
   }
   return 0;
 }
 
 static double compute_intercept(
     const double vof,
-    const double normal[NDIMS]
+    const double exps[NGAUSS * NGAUSS],
+    const double guess,
+    int * niters
 ){
   // Newton-Raphson method, loop terminating conditions | 2
-  const int cntmax = 8;
+  const int cntmax = INTERFACE_NITERSMAX;
   const double resmax = 1.e-12;
-  // compute constants a priori | 11
-  double exps[NGAUSS * NGAUSS] = {0.};
-  for(int jj = 0; jj < NGAUSS; jj++){
-    for(int ii = 0; ii < NGAUSS; ii++){
-      exps[jj * NGAUSS + ii] = exp(
-          -2. * vofbeta * (
-            + normal[0] * gauss_ps[ii]
-            + normal[1] * gauss_ps[jj]
-          )
-      );
-    }
-  }
   // initial guess | 1
-  double val = 1. / vof - 1.;
+  double val = guess;
+  // not converged unless the residual becomes small enough
+  *niters = cntmax + 1;
   for(int cnt = 0; cnt < cntmax; cnt++){
     // sum up | 25
     double f0 = -1. * vof;
@@ -81,107 +112,267 @@ static double compute_intercept(
         f1 -= weight * p * denom * denom;
       }
     }
-    // update D | 1
-    val -= f0 / f1;
+    // update D, which should be positive | 2
+    const double next = val - f0 / f1;
+    val = 0. < next ? next : 0.5 * val;
     if(fabs(f0) < resmax){
+      *niters = cnt + 1;
       break;
     }
   }
-  // convert D to d | 1
-  return -0.5 / vofbeta * log(val);
+  // D = exp(-2 beta d) is returned
+  return val;
 }
 
-static int compute_normal(
-    const domain_t * domain,
-    interface_t * interface
+static double compute_guess(
+    const double vof,
+    const double nx,
+    const double ny,
+    const double cache
 ){
-  const int isize = domain->mysizes[0];
-  const int jsize = domain->mysizes[1];
-  const double * restrict dxf = domain->dxf;
-  const double            dy  = domain->dy;
-  const double * restrict vof = interface->vof.data;
-  const vector_t * restrict dvof = interface->dvof.data;
-  normal_t * restrict normal = interface->normal.data;
-  for(int j = 0; j <= jsize + 1; j++){
-    for(int i = 1; i <= isize; i++){
-      const double dx = DXF(i  );
-      const double lvof = VOF(i, j);
-      // for (almost) single-phase region,
-      //   surface reconstruction is not needed
-      if(lvof < vofmin || 1. - vofmin < lvof){
-        continue;
-      }
-      // average nx | 4
-      double nx = (
-          + DVOF(i  , j  )[0] + DVOF(i+1, j  )[0]
-          + DVOF(i  , j+1)[0] + DVOF(i+1, j+1)[0]
-      );
-      // average ny | 4
-      double ny = (
-          + DVOF(i  , j  )[1] + DVOF(i+1, j  )[1]
-          + DVOF(i  , j+1)[1] + DVOF(i+1, j+1)[1]
-      );
-      // normalise and obtain center normals | 9
-      nx /= dx;
-      ny /= dy;
-      const double norm = sqrt(
-          + pow(nx, 2.)
-          + pow(ny, 2.)
-      );
-      const double norminv = 1. / fmax(norm, DBL_EPSILON);
-      nx *= norminv;
-      ny *= norminv;
-      const double seg = compute_intercept(
-          lvof,
-          (const double [NDIMS]){nx, ny}
-      );
-      // store normal and intercept | 3
-      NORMAL(i, j)[0] = nx;
-      NORMAL(i, j)[1] = ny;
-      NORMAL(i, j)[2] = seg;
+  // previous solution of this cell, if available
+  if(param_interface_warm_start && 0. < cache){
+    return cache;
+  }
+  // closed-form solution of the one-dimensional two-point problem
+  //   0.5 / (1 + exp(-a) D) + 0.5 / (1 + exp(+a) D) = vof,
+  //   where a is the root-mean-square exponent
+  //   2 beta |x n| over the Gauss points
+  if(param_interface_closed_form_guess && 2 == NGAUSS){
+    const double a = 2. * vofbeta * fabs(gauss_ps[0]) * sqrt(
+        + pow(nx, 2.)
+        + pow(ny, 2.)
+    );
+    const double c = cosh(a);
+    const double b = c * (1. - 2. * vof);
+    return 0.5 / vof * (b + sqrt(
+          + pow(b, 2.)
+          + 4. * vof * (1. - vof)
+    ));
+  }
+  return 1. / vof - 1.;
+}
+
+static int compute_exponentials(
+    const double normal[NDIMS],
+    thinc_t * thinc
+){
+  // exp(-2 beta n x) at the cell face and the Gauss points,
+  //   products of which give all factors needed
+  for(int dim = 0; dim < NDIMS; dim++){
+    thinc->faces[dim] = exp(-1. * vofbeta * normal[dim]);
+    for(int n = 0; n < NGAUSS; n++){
+      thinc->gauss[dim][n] = exp(-2. * vofbeta * normal[dim] * gauss_ps[n]);
     }
   }
   return 0;
 }
 
-static int compute_curvature(
-    const domain_t * domain,
-    interface_t * interface
+// find intercept of a mixed cell,
+//   whose normal is already computed
+static double compute_segment(
+    const double lvof,
+    const double nx,
+    const double ny,
+    const double guess,
+    int * niters,
+    double * seg,
+    thinc_t * thinc
 ){
-  const int isize = domain->mysizes[0];
-  const int jsize = domain->mysizes[1];
-  const double * restrict dxf = domain->dxf;
-  const double            dy  = domain->dy;
-  const vector_t * restrict dvof = interface->dvof.data;
-  double * restrict curv = interface->curv.data;
-  for(int j = 0; j <= jsize + 1; j++){
-    for(int i = 1; i <= isize; i++){
-      const double dx = DXF(i  );
-      // compute mean curvature from corner normals | 12
-      const double dnxdx = 1. / dx * (
-          - DVOF(i  , j  )[0] + DVOF(i+1, j  )[0]
-          - DVOF(i  , j+1)[0] + DVOF(i+1, j+1)[0]
-      );
-      const double dnydy = 1. / dy * (
-          - DVOF(i  , j  )[1] - DVOF(i+1, j  )[1]
-          + DVOF(i  , j+1)[1] + DVOF(i+1, j+1)[1]
-      );
-      CURV(i, j) = 0.5 * (
-        - dnxdx
-        - dnydy
-      );
+  if(param_interface_reuse_exponentials){
+    // compute and store exponential factors,
+    //   intercept itself is not needed
+    compute_exponentials((const double [NDIMS]){nx, ny}, thinc);
+    double exps[NGAUSS * NGAUSS] = {0.};
+    for(int jj = 0; jj < NGAUSS; jj++){
+      for(int ii = 0; ii < NGAUSS; ii++){
+        exps[jj * NGAUSS + ii] = thinc->gauss[0][ii] * thinc->gauss[1][jj];
+      }
     }
+    thinc->d = compute_intercept(lvof, exps, guess, niters);
+    return thinc->d;
+  }else{
+    // compute constants a priori | 11
+    double exps[NGAUSS * NGAUSS] = {0.};
+    for(int jj = 0; jj < NGAUSS; jj++){
+      for(int ii = 0; ii < NGAUSS; ii++){
+        exps[jj * NGAUSS + ii] = exp(
+            -2. * vofbeta * (
+              + nx * gauss_ps[ii]
+              + ny * gauss_ps[jj]
+            )
+        );
+      }
+    }
+    // convert D to d and store | 2
+    const double val = compute_intercept(lvof, exps, guess, niters);
+    *seg = -0.5 / vofbeta * log(val);
+    return val;
+  }
+}
+
+// compute curvature and center normals of a row from corner normals,
+//   which is specialised for uniform x grids by giving a constant "is_uniform"
+static inline int compute_curvature_and_normal(
+    const domain_t * domain,
+    const bool is_uniform,
+    const interface_t * interface,
+    const int j,
+    double * const dvofm[NDIMS],
+    double * const dvofp[NDIMS]
+){
+  const double * restrict dxfinv = domain->dxfinv;
+  // constant metric of uniform grids
+  const double            dxinv  = domain->dxfinv[0];
+  const double            dyinv  = domain->dyinv;
+  const int (* restrict branges)[2] = interface->band.ranges;
+  const int * restrict boffsets = interface->band.offsets;
+  double * const * normal = interface->normal;
+  double * restrict curv = interface->curv;
+  // lower (m) and upper (p) corners of this row,
+  //   indexed by the corner index minus one
+  const double * restrict dvofxm = dvofm[0];
+  const double * restrict dvofym = dvofm[1];
+  const double * restrict dvofxp = dvofp[0];
+  const double * restrict dvofyp = dvofp[1];
+  const int is = BRANGES(j)[0];
+  const int ie = BRANGES(j)[1];
+  // compute mean curvature from corner normals | 15
+  for(int i = is; i <= ie; i++){
+    const double lxinv = is_uniform ? dxinv : DXFINV(i  );
+    const double dnxdx = lxinv * (
+        - dvofxm[i - 1] + dvofxm[i    ]
+        - dvofxp[i - 1] + dvofxp[i    ]
+    );
+    const double dnydy = dyinv * (
+        - dvofym[i - 1] - dvofym[i    ]
+        + dvofyp[i - 1] + dvofyp[i    ]
+    );
+    CURV(i, j) = 0.5 * (
+      - dnxdx
+      - dnydy
+    );
+  }
+  // average corner normals to obtain center normals | 22
+  for(int i = is; i <= ie; i++){
+    const double lxinv = is_uniform ? dxinv : DXFINV(i  );
+    double nx = (
+        + dvofxm[i - 1] + dvofxm[i    ]
+        + dvofxp[i - 1] + dvofxp[i    ]
+    );
+    double ny = (
+        + dvofym[i - 1] + dvofym[i    ]
+        + dvofyp[i - 1] + dvofyp[i    ]
+    );
+    nx *= lxinv;
+    ny *= dyinv;
+    const double norm = sqrt(
+        + pow(nx, 2.)
+        + pow(ny, 2.)
+    );
+    const double norminv = 1. / (DBL_EPSILON < norm ? norm : DBL_EPSILON);
+    NORMAL(i, j, 0) = nx * norminv;
+    NORMAL(i, j, 1) = ny * norminv;
   }
   return 0;
 }
 
+/**
+ * @brief compute surface normal, intercept and curvature in the narrow band
+ * @param[in]     domain    : information about domain decomposition and size
+ * @param[in,out] interface : vof field (in), band-packed quantities (out)
+ * @return                  : error code
+ */
 int interface_compute_curvature_tensor(
     const domain_t * domain,
     interface_t * interface
 ){
-  compute_gradient(domain, interface);
-  compute_normal(domain, interface);
-  compute_curvature(domain, interface);
+  // find cells which need to be considered
+  if(0 != interface_compute_band(domain, interface)){
+    return 1;
+  }
+  const int isize = domain->mysizes[0];
+  const int jsize = domain->mysizes[1];
+  const int (* restrict branges)[2] = interface->band.ranges;
+  const int * restrict boffsets = interface->band.offsets;
+  const double * restrict vof = interface->vof.data;
+  double * const * normal = interface->normal;
+  thinc_t * restrict thinc = interface->thinc;
+  double * restrict dcache = interface->dcache.data;
+  bool x_grid_is_uniform = false;
+  domain_check_x_grid_is_uniform(domain, &x_grid_is_uniform);
+  thinc_t neutral = {.d = 1.};
+  for(int dim = 0; dim < NDIMS; dim++){
+    neutral.faces[dim] = 1.;
+    for(int n = 0; n < NGAUSS; n++){
+      neutral.gauss[dim][n] = 1.;
+    }
+  }
+  // the rows [0 : jsize + 1] are split into contiguous chunks, one per thread
+  const int nchunks = threads_get_nthreads();
+  const int nrows = jsize + 2;
+  THREADS_PRAGMA(omp parallel for schedule(static))
+  for(int chunk = 0; chunk < nchunks; chunk++){
+    const int js =     nrows *  chunk      / nchunks;
+    const int je = -1 + nrows * (chunk + 1) / nchunks;
+    const interface_rows_t * rows = interface->rows + threads_get_mythread();
+    // histogram of this chunk, which is added to the global one later
+    size_t hist[INTERFACE_NITERSMAX + 1] = {0};
+    // corner normals of two consecutive rows,
+    //   the corner row j is stored in dvof[j % 2]
+    //   so that the window slides upwards as j increases
+    compute_gradient(domain, interface, js, rows->dvof[js % 2]);
+    for(int j = js; j <= je; j++){
+      compute_gradient(domain, interface, j + 1, rows->dvof[(j + 1) % 2]);
+      // lower (m) and upper (p) corners of this row
+      double * const * dvofm = rows->dvof[(j    ) % 2];
+      double * const * dvofp = rows->dvof[(j + 1) % 2];
+      if(x_grid_is_uniform){
+        compute_curvature_and_normal(domain, true, interface, j, dvofm, dvofp);
+      }else{
+        compute_curvature_and_normal(domain, false, interface, j, dvofm, dvofp);
+      }
+      // find intercepts of mixed cells
+      const int is = BRANGES(j)[0];
+      const int ie = BRANGES(j)[1];
+      for(int i = is; i <= ie; i++){
+        // for (almost) single-phase region,
+        //   surface reconstruction is not needed
+        const double lvof = VOF(i, j);
+        if(lvof < vofmin || 1. - vofmin < lvof){
+          // neutral factors, which are evaluated by the flux kernels
+          //   but are discarded for pure cells
+          THINC(i, j) = neutral;
+          // no solution to be re-used
+          if(param_interface_warm_start){
+            DCACHE(i, j) = 0.;
+          }
+          continue;
+        }
+        const double nx = NORMAL(i, j, 0);
+        const double ny = NORMAL(i, j, 1);
+        int niters = 0;
+        const double cache = param_interface_warm_start ? DCACHE(i, j) : 0.;
+        const double d = compute_segment(
+            lvof,
+            nx,
+            ny,
+            compute_guess(lvof, nx, ny, cache),
+            &niters,
+            &NORMAL(i, j, NDIMS),
+            &THINC(i, j)
+        );
+        if(param_interface_warm_start){
+          DCACHE(i, j) = d;
+        }
+        hist[niters - 1] += 1;
+      }
+    }
+    for(int n = 0; n < INTERFACE_NITERSMAX + 1; n++){
+      THREADS_PRAGMA(omp atomic)
+      interface->niters[n] += hist[n];
+    }
+  }
   return 0;
 }
 
@@ -1,17 +1,17 @@
+#include "param.h"
 #include "config.h"
+#include "memory.h"
+#include "threads.h"
 #include "domain.h"
 #include "interface.h"
 #include "interface_solver.h"
 #include "fileio.h"
 #include "array_macros/interface/vof.h"
-#include "array_macros/interface/ifrcx.h"
-#include "array_macros/interface/ifrcy.h"
-#include "array_macros/interface/dvof.h"
-#include "array_macros/interface/normal.h"
-#include "array_macros/interface/curv.h"
-#include "array_macros/interface/flxx.h"
-#include "array_macros/interface/flxy.h"
+#include "array_macros/interface/band.h"
 #include "array_macros/interface/src.h"
+#include "array_macros/interface/dcache.h"
+#include "array_macros/fluid/ux.h"
+#include "array_macros/fluid/uy.h"
 
 /**
  * @brief allocate interface_t
@@ -24,15 +24,55 @@ static int allocate(
     interface_t * interface
 ){
   if(0 != array.prepare(domain, VOF_NADDS, sizeof(double), &interface->vof)) return 1;
-  if(0 != array.prepare(domain, IFRCX_NADDS, sizeof(double), &interface->ifrcx)) return 1;
-  if(0 != array.prepare(domain, IFRCY_NADDS, sizeof(double), &interface->ifrcy)) return 1;
-  if(0 != array.prepare(domain, DVOF_NADDS, sizeof(vector_t), &interface->dvof)) return 1;
-  if(0 != array.prepare(domain, NORMAL_NADDS, sizeof(normal_t), &interface->normal)) return 1;
-  if(0 != array.prepare(domain, CURV_NADDS, sizeof(double), &interface->curv)) return 1;
-  if(0 != array.prepare(domain, FLXX_NADDS, sizeof(double), &interface->flxx)) return 1;
-  if(0 != array.prepare(domain, FLXY_NADDS, sizeof(double), &interface->flxy)) return 1;
-  for(size_t n = 0; n < 2; n++){
-    if(0 != array.prepare(domain, SRC_NADDS, sizeof(double), &interface->src[n])) return 1;
+  // narrow band, band-packed buffers are allocated when the band is found
+  {
+    const size_t nrows = domain->mysizes[1] + BAND_NADDS[1][0] + BAND_NADDS[1][1];
+    interface->band.ranges  = memory_calloc(nrows, sizeof(int [2]));
+    interface->band.offsets = memory_calloc(nrows, sizeof(int));
+    interface->band.nitems   = 0;
+    interface->band.capacity = 0;
+    for(size_t n = 0; n < NDIMS + 1; n++){
+      interface->normal[n] = NULL;
+    }
+    interface->curv   = NULL;
+    interface->thinc  = NULL;
+  }
+  // row buffers and lower y fluxes of the chunks, one per thread
+  const int nthreads = threads_get_nthreads();
+  interface->rows  = memory_calloc(nthreads, sizeof(interface_rows_t));
+  interface->edges = memory_calloc(nthreads, sizeof(double *));
+  for(int m = 0; m < nthreads; m++){
+    interface_rows_t * rows = interface->rows + m;
+    // two rows of corner normals, [1 : isize+1]
+    for(size_t n = 0; n < 2; n++){
+      for(size_t dim = 0; dim < NDIMS; dim++){
+        rows->dvof[n][dim] = memory_calloc(domain->mysizes[0] + 1, sizeof(double));
+      }
+    }
+    // face-averaged vof of a row, [1 : isize]
+    for(size_t n = 0; n < 2; n++){
+      rows->fvof[n] = memory_calloc(domain->mysizes[0], sizeof(double));
+    }
+    // vof fluxes of a row, [1 : isize+1] and [1 : isize]
+    rows->flxx = memory_calloc(domain->mysizes[0] + 1, sizeof(double));
+    for(size_t n = 0; n < 2; n++){
+      rows->flxy[n] = memory_calloc(domain->mysizes[0], sizeof(double));
+    }
+    // lower y fluxes of a chunk, [1 : isize]
+    interface->edges[m] = memory_calloc(domain->mysizes[0], sizeof(double));
+  }
+  // x fluxes at the tile boundaries, [1 : jsize]
+  interface->seam = memory_calloc(domain->mysizes[1], sizeof(double));
+  if(0 != array.prepare(domain, SRC_NADDS, sizeof(double), &interface->src)) return 1;
+  for(size_t n = 0; n < INTERFACE_NITERSMAX + 1; n++){
+    interface->niters[n] = 0;
+  }
+  if(param_interface_warm_start){
+    if(0 != array.prepare(domain, DCACHE_NADDS, sizeof(double), &interface->dcache)) return 1;
+  }
+  if(param_interface_once_per_step){
+    if(0 != array.prepare(domain, UX_NADDS, sizeof(double), &interface->ux)) return 1;
+    if(0 != array.prepare(domain, UY_NADDS, sizeof(double), &interface->uy)) return 1;
   }
   return 0;
 }
@@ -48,6 +88,7 @@ static void report(
     FILE * stream = stdout;
     fprintf(stream, "INTERFACE\n");
     fprintf(stream, "\tsurface tension: % .7e\n", interface->tension);
+    fprintf(stream, "\tvof transport: %s\n", param_interface_once_per_step ? "once per step" : "every RK stage");
     fflush(stream);
   }
 }
@@ -1,11 +1,73 @@
 #if !defined(INTERFACE_INTERNAL_H)
 #define INTERFACE_INTERNAL_H
 
+#include "domain.h"
+#include "interface.h"
+
+// number of Gauss points and sharpness of the THINC function,
+//   which are fixed at build time (e.g. -DNGAUSS=3 -DVOFBETA=1.5)
+//   so that the kernels are specialised and fully unrolled
+#if !defined(NGAUSS)
 #define NGAUSS 2
-extern const double gauss_ps[NGAUSS];
-extern const double gauss_ws[NGAUSS];
+#endif
+#if !defined(VOFBETA)
+#define VOFBETA 1.
+#endif
+
+#if NGAUSS == 1
+// 0
+static const double gauss_ps[NGAUSS] = {
+  0.,
+};
+static const double gauss_ws[NGAUSS] = {
+  1.,
+};
+#elif NGAUSS == 2
+// pm 1 / 2 / sqrt(3)
+static const double gauss_ps[NGAUSS] = {
+  - 0.2886751345948129,
+  + 0.2886751345948129,
+};
+static const double gauss_ws[NGAUSS] = {
+  + 0.5,
+  + 0.5,
+};
+#elif NGAUSS == 3
+// 0, pm 1 / 2 * sqrt(3 / 5)
+static const double gauss_ps[NGAUSS] = {
+  - 0.3872983346207417,
+    0.,
+  + 0.3872983346207417,
+};
+static const double gauss_ws[NGAUSS] = {
+  + 0.2777777777777778,
+  + 0.4444444444444444,
+  + 0.2777777777777778,
+};
+#else
+#error "NGAUSS should be 1, 2, or 3"
+#endif
+
+static const double vofbeta = VOFBETA;
+static const double vofmin = 1.e-8;
+
+// exponential factors of the THINC function of a cell,
+//   so that the surface indicator at (x, y) is given by
+//   H = 1 / (1 + d * exp(-2 beta nx x) * exp(-2 beta ny y))
+//   without evaluating transcendental functions
+typedef struct {
+  // exp(-2 beta d), d: intercept
+  double d;
+  // exp(-2 beta n x) at the positive cell face (x = +1/2),
+  //   whose reciprocal gives the one at the negative face
+  double faces[NDIMS];
+  // exp(-2 beta n x) at the Gauss points
+  double gauss[NDIMS][NGAUSS];
+} thinc_t;
 
-extern const double vofbeta;
-extern const double vofmin;
+extern int interface_compute_band(
+    const domain_t * domain,
+    interface_t * interface
+);
 
 #endif // INTERFACE_INTERNAL_H
@@ -1,44 +1,52 @@
 #include "domain.h"
-#include "fluid.h"
 #include "interface.h"
+#include "threads.h"
 #include "../internal.h"
 #include "internal.h"
 #include "array_macros/fluid/ux.h"
-#include "array_macros/interface/vof.h"
-#include "array_macros/interface/normal.h"
-#include "array_macros/interface/flxx.h"
 
+/**
+ * @brief compute x fluxes of the vof field in a row of a tile
+ * @param[in]  domain    : information about domain decomposition and size
+ * @param[in]  ux        : x velocity
+ * @param[in]  interface : vof field and reconstructed interface
+ * @param[in]  j         : row index
+ * @param[in]  is, ie    : range of the tile
+ * @param[out] flxx      : fluxes at the x faces of the row, [is+1 : ie+1],
+ *                           the left face of the tile is not computed
+ * @return               : error code
+ */
 int compute_flux_x(
     const domain_t * domain,
-    const fluid_t * fluid,
-    interface_t * interface
+    const double * restrict ux,
+    const interface_t * interface,
+    const int j,
+    const int is,
+    const int ie,
+    double * restrict flxx
 ){
   const int isize = domain->mysizes[0];
-  const int jsize = domain->mysizes[1];
-  const double * restrict ux = fluid->ux.data;
-  const double * restrict vof = interface->vof.data;
-  const normal_t * restrict normal = interface->normal.data;
-  double * restrict flxx = interface->flxx.data;
-  for(int j = 1; j <= jsize; j++){
-    for(int i = 2; i <= isize; i++){
-      // use upwind information | 3
-      const double vel = UX(i, j);
-      const int    ii = vel < 0. ?    i : i - 1;
-      const double  x = vel < 0. ? -0.5 :  +0.5;
-      // evaluate flux | 12
-      const double lvof = VOF(ii, j);
-      if(lvof < vofmin || 1. - vofmin < lvof){
-        FLXX(i, j) = vel * lvof;
-        continue;
-      }
-      double flux = 0.;
-      for(int jj = 0; jj < NGAUSS; jj++){
-        const double w = gauss_ws[jj];
-        const double y = gauss_ps[jj];
-        flux += w * indicator(NORMAL(ii, j), (const double [NDIMS]){x, y});
-      }
-      FLXX(i, j) = vel * flux;
-    }
+  // right-most face which is not on the wall
+  const int ief = ie < isize ? ie + 1 : isize;
+  // face-averaged vof of the cells in this row,
+  //   including the right neighbour of the tile, which is not updated yet
+  // NOTE: the left neighbour of the tile, which has already been updated,
+  //   is not referred to since it is needed only by the left face
+  const interface_rows_t * rows = interface->rows + threads_get_mythread();
+  double * restrict vofm = rows->fvof[0];
+  double * restrict vofp = rows->fvof[1];
+  compute_face_vof(domain, interface, 0, j, is, ief, vofm, vofp);
+  // impermeable wall
+  if(isize == ie){
+    flxx[isize] = 0.;
+  }
+  // use upwind information, without branches,
+  //   both candidates are loaded so that the loop is vectorised
+  for(int i = is + 1; i <= ief; i++){
+    const double vel = UX(i, j);
+    const double lvofm = vofm[i - 1];
+    const double lvofp = vofp[i - 2];
+    flxx[i - 1] = vel * (vel < 0. ? lvofm : lvofp);
   }
   return 0;
 }
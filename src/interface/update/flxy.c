@@ -1,44 +1,44 @@
 #include "domain.h"
-#include "fluid.h"
 #include "interface.h"
+#include "threads.h"
 #include "../internal.h"
 #include "internal.h"
 #include "array_macros/fluid/uy.h"
-#include "array_macros/interface/vof.h"
-#include "array_macros/interface/normal.h"
-#include "array_macros/interface/flxy.h"
 
+/**
+ * @brief compute y fluxes of the vof field at the lower faces of a row of a tile
+ * @param[in]  domain    : information about domain decomposition and size
+ * @param[in]  uy        : y velocity
+ * @param[in]  interface : vof field and reconstructed interface
+ * @param[in]  j         : row index
+ * @param[in]  is, ie    : range of the tile
+ * @param[out] flxy      : fluxes at the y faces of the row, [is : ie]
+ * @return               : error code
+ */
 int compute_flux_y(
     const domain_t * domain,
-    const fluid_t * fluid,
-    interface_t * interface
+    const double * restrict uy,
+    const interface_t * interface,
+    const int j,
+    const int is,
+    const int ie,
+    double * restrict flxy
 ){
   const int isize = domain->mysizes[0];
-  const int jsize = domain->mysizes[1];
-  const double * restrict uy = fluid->uy.data;
-  const double * restrict vof = interface->vof.data;
-  const normal_t * restrict normal = interface->normal.data;
-  double * restrict flxy = interface->flxy.data;
-  for(int j = 1; j <= jsize + 1; j++){
-    for(int i = 1; i <= isize; i++){
-      // use upwind information | 3
-      const double vel = UY(i, j);
-      const int    jj = vel < 0. ?    j : j - 1;
-      const double  y = vel < 0. ? -0.5 :  +0.5;
-      // evaluate flux | 12
-      const double lvof = VOF(i, jj);
-      if(lvof < vofmin || 1. - vofmin < lvof){
-        FLXY(i, j) = vel * lvof;
-        continue;
-      }
-      double flux = 0.;
-      for(int ii = 0; ii < NGAUSS; ii++){
-        const double w = gauss_ws[ii];
-        const double x = gauss_ps[ii];
-        flux += w * indicator(NORMAL(i, jj), (const double [NDIMS]){x, y});
-      }
-      FLXY(i, j) = vel * flux;
-    }
+  // face-averaged vof,
+  //   upper faces of the row j-1 and lower faces of the row j
+  const interface_rows_t * rows = interface->rows + threads_get_mythread();
+  double * restrict vofm = rows->fvof[0];
+  double * restrict vofp = rows->fvof[1];
+  compute_face_vof(domain, interface, 1, j - 1, is, ie, NULL, vofp);
+  compute_face_vof(domain, interface, 1, j    , is, ie, vofm, NULL);
+  // use upwind information, without branches,
+  //   both candidates are loaded so that the loop is vectorised
+  for(int i = is; i <= ie; i++){
+    const double vel = UY(i, j);
+    const double lvofm = vofm[i - 1];
+    const double lvofp = vofp[i - 1];
+    flxy[i - 1] = vel * (vel < 0. ? lvofm : lvofp);
   }
   return 0;
 }
@@ -8,16 +8,35 @@ extern double indicator(
     const vector_t x
 );
 
+extern int compute_face_vof(
+    const domain_t * domain,
+    const interface_t * interface,
+    const int dim,
+    const int j,
+    const int is,
+    const int ie,
+    double * restrict vofm,
+    double * restrict vofp
+);
+
 extern int compute_flux_x(
     const domain_t * domain,
-    const fluid_t * fluid,
-    interface_t * interface
+    const double * restrict ux,
+    const interface_t * interface,
+    const int j,
+    const int is,
+    const int ie,
+    double * restrict flxx
 );
 
 extern int compute_flux_y(
     const domain_t * domain,
-    const fluid_t * fluid,
-    interface_t * interface
+    const double * restrict uy,
+    const interface_t * interface,
+    const int j,
+    const int is,
+    const int ie,
+    double * restrict flxy
 );
 
 
@@ -1,17 +1,21 @@
 #include <math.h>
+#include <stdbool.h>
 #include <string.h>
+#include "param.h"
 #include "runge_kutta.h"
+#include "tiling.h"
 #include "domain.h"
 #include "fluid.h"
 #include "interface.h"
 #include "interface_solver.h"
+#include "threads.h"
 #include "../internal.h"
 #include "internal.h"
-#include "array_macros/domain/dxf.h"
+#include "array_macros/domain/dxfinv.h"
 #include "array_macros/interface/vof.h"
-#include "array_macros/interface/flxx.h"
-#include "array_macros/interface/flxy.h"
-#include "array_macros/interface/src.h"
+#include "array_macros/interface/band.h"
+#include "array_macros/interface/normal.h"
+#include "array_macros/interface/thinc.h"
 
 double indicator(
     const normal_t n,
@@ -25,87 +29,226 @@ double indicator(
   )));
 }
 
-static int reset_srcs(
-    const size_t rkstep,
-    array_t * restrict srca,
-    array_t * restrict srcb
+/**
+ * @brief compute vof at the negative and positive faces of the cells in a row
+ * @param[in]  domain    : information about domain decomposition and size
+ * @param[in]  interface : vof field and reconstructed interface
+ * @param[in]  dim       : direction of the faces
+ * @param[in]  j         : row index
+ * @param[in]  is, ie    : range of the cells
+ * @param[out] vofm      : face-averaged vof at the negative faces, [is : ie], or NULL
+ * @param[out] vofp      : face-averaged vof at the positive faces, [is : ie], or NULL
+ * @return               : error code
+ */
+int compute_face_vof(
+    const domain_t * domain,
+    const interface_t * interface,
+    const int dim,
+    const int j,
+    const int is,
+    const int ie,
+    double * restrict vofm,
+    double * restrict vofp
 ){
-  // copy previous k-step source term and reset
-  if(0 != rkstep){
-    // stash previous RK source term,
-    //   which is achieved by swapping
-    //   the pointers to "data"
-    double * tmp = srca->data;
-    srca->data = srcb->data;
-    srcb->data = tmp;
+  // the other direction, along which the Gauss quadrature is applied
+  const int odim = 1 - dim;
+  const int isize = domain->mysizes[0];
+  const double * restrict vof = interface->vof.data;
+  // mixed cells are always in the narrow band
+  const int (* restrict branges)[2] = interface->band.ranges;
+  const int * restrict boffsets = interface->band.offsets;
+  double * const * normal = interface->normal;
+  const thinc_t * restrict thinc = interface->thinc;
+  // pure cells, which are overwritten later if mixed
+  for(int i = is; i <= ie; i++){
+    const double lvof = VOF(i, j);
+    if(vofm) vofm[i - 1] = lvof;
+    if(vofp) vofp[i - 1] = lvof;
+  }
+  // mixed cells are searched in the overlap with the band
+  const int ibs = BRANGES(j)[0] < is ? is : BRANGES(j)[0];
+  const int ibe = BRANGES(j)[1] < ie ? BRANGES(j)[1] : ie;
+  if(param_interface_reuse_exponentials){
+    // products of the stored exponential factors,
+    //   pure cells in the band have neutral factors
+    //   and are handled by blending without branches
+    for(int i = ibs; i <= ibe; i++){
+      const double lvof = VOF(i, j);
+      const bool is_mixed = vofmin <= lvof && lvof <= 1. - vofmin;
+      const thinc_t * t = &THINC(i, j);
+      const double dm = t->d / t->faces[dim];
+      const double dp = t->d * t->faces[dim];
+      double fluxm = 0.;
+      double fluxp = 0.;
+      for(int n = 0; n < NGAUSS; n++){
+        const double w = gauss_ws[n];
+        fluxm += w / (1. + dm * t->gauss[odim][n]);
+        fluxp += w / (1. + dp * t->gauss[odim][n]);
+      }
+      if(vofm) vofm[i - 1] = is_mixed ? fluxm : lvof;
+      if(vofp) vofp[i - 1] = is_mixed ? fluxp : lvof;
+    }
+  }else{
+    for(int i = ibs; i <= ibe; i++){
+      const double lvof = VOF(i, j);
+      if(lvof < vofmin || 1. - vofmin < lvof){
+        continue;
+      }
+      const normal_t n = {
+        NORMAL(i, j, 0),
+        NORMAL(i, j, 1),
+        NORMAL(i, j, NDIMS),
+      };
+      double fluxm = 0.;
+      double fluxp = 0.;
+      for(int m = 0; m < NGAUSS; m++){
+        const double w = gauss_ws[m];
+        vector_t xm = {0.};
+        vector_t xp = {0.};
+        xm[ dim] = -0.5;
+        xp[ dim] = +0.5;
+        xm[odim] = gauss_ps[m];
+        xp[odim] = gauss_ps[m];
+        fluxm += w * indicator(n, xm);
+        fluxp += w * indicator(n, xp);
+      }
+      if(vofm) vofm[i - 1] = fluxm;
+      if(vofp) vofp[i - 1] = fluxp;
+    }
   }
-  // zero-clear current RK source terms
-  memset(srca->data, 0, srca->datasize);
   return 0;
 }
 
-static int interface_compute_rhs(
+// advect vof field in a tile, row by row,
+//   which is specialised for uniform x grids by giving a constant "is_uniform"
+static inline int advect_vof_kernel(
     const domain_t * domain,
+    const bool is_uniform,
+    const double coef_a,
+    const double coef_b,
+    const double dt,
+    const double * restrict ux,
+    const double * restrict uy,
+    const int is,
+    const int ie,
     interface_t * interface
 ){
+  // fluxes are computed on the fly and the vof field is updated in-place,
+  //   which is safe since the fluxes of the row j only refer to the rows j-1, j, j+1
+  //   and the upper y fluxes are computed before the row j is updated
+  // likewise, tiles are swept from left to right
+  //   and the left x fluxes of a tile are taken over from the previous tile,
+  //   which are computed before the cells there are updated
+  // the rows are split into contiguous chunks, one per thread,
+  //   whose lower y fluxes are computed before any cell is updated
+  //   and are used as the upper ones of the chunk below as well
   const int isize = domain->mysizes[0];
   const int jsize = domain->mysizes[1];
-  const double * restrict dxf = domain->dxf;
-  const double            dy  = domain->dy;
-  const double * restrict flxx = interface->flxx.data;
-  const double * restrict flxy = interface->flxy.data;
-  double * restrict src = interface->src[rk_a].data;
-  // compute right-hand-side of advection equation, x flux | 23
-  for(int j = 1; j <= jsize; j++){
-    for(int i = 1; i <= isize; i++){
-      const double dx = DXF(i  );
-      SRC(i, j) += 1. / dx * (
-          + FLXX(i  , j  )
-          - FLXX(i+1, j  )
-      );
+  const double * restrict dxfinv = domain->dxfinv;
+  // constant metric of uniform grids
+  const double            dxinv  = domain->dxfinv[0];
+  const double            dyinv  = domain->dyinv;
+  double * restrict src = interface->src.data;
+  double * restrict vof = interface->vof.data;
+  double * restrict seam = interface->seam;
+  double * const * edges = interface->edges;
+  const int nchunks = threads_get_nthreads();
+  THREADS_PRAGMA(omp parallel)
+  {
+    THREADS_PRAGMA(omp for schedule(static))
+    for(int chunk = 0; chunk < nchunks; chunk++){
+      const int js = 1 + jsize * chunk / nchunks;
+      compute_flux_y(domain, uy, interface, js, is, ie, edges[chunk]);
     }
-  }
-  // compute right-hand-side of advection equation, y flux | 21
-  for(int j = 1; j <= jsize; j++){
-    for(int i = 1; i <= isize; i++){
-      SRC(i, j) += 1. / dy * (
-          + FLXY(i  , j  )
-          - FLXY(i  , j+1)
-      );
+    // NOTE: implicit barrier, all lower fluxes are ready
+    THREADS_PRAGMA(omp for schedule(static))
+    for(int chunk = 0; chunk < nchunks; chunk++){
+      const int js = 1 + jsize *  chunk      / nchunks;
+      const int je =     jsize * (chunk + 1) / nchunks;
+      const interface_rows_t * rows = interface->rows + threads_get_mythread();
+      double * restrict flxx = rows->flxx;
+      const double * restrict flxym = edges[chunk];
+      for(int j = js; j <= je; j++){
+        // left face of the tile, wall or right face of the previous tile
+        flxx[is - 1] = 1 == is ? 0. : seam[j - 1];
+        compute_flux_x(domain, ux, interface, j, is, ie, flxx);
+        // upper y fluxes, which are the lower ones of the next chunk
+        //   at the top of the chunk since the next row may have been updated
+        const double * restrict flxyp = rows->flxy[j % 2];
+        if(je == j && nchunks != chunk + 1){
+          flxyp = edges[chunk + 1];
+        }else{
+          compute_flux_y(domain, uy, interface, j + 1, is, ie, rows->flxy[j % 2]);
+        }
+        seam[j - 1] = flxx[ie];
+        // source terms, which have no halo and are accessed linearly
+        const size_t offset = (size_t)isize * (j - 1);
+        // compute right-hand-side of advection equation | 11
+        for(int i = is; i <= ie; i++){
+          const double lxinv = is_uniform ? dxinv : DXFINV(i  );
+          const double lsrc = lxinv * (
+              + flxx[i - 1]
+              - flxx[i    ]
+          ) + dyinv * (
+              + flxym[i - 1]
+              - flxyp[i - 1]
+          );
+          VOF(i, j) += dt * coef_a * lsrc;
+          // beta contribution, using the previous source term
+          //   which is then replaced by the current one
+          if(0. != coef_b){
+            VOF(i, j) += dt * coef_b * src[offset + i - 1];
+          }
+          src[offset + i - 1] = lsrc;
+        }
+        // upper y fluxes are re-used as the lower ones of the next row
+        flxym = flxyp;
+      }
     }
   }
   return 0;
 }
 
-static int interface_advect_vof(
+/**
+ * @brief advect vof field, tile by tile
+ * @param[in]     domain    : information about domain decomposition and size
+ * @param[in]     coef_a    : coefficient of the current source term
+ * @param[in]     coef_b    : coefficient of the previous source term
+ * @param[in]     dt        : time step size
+ * @param[in]     ux        : x velocity
+ * @param[in]     uy        : y velocity
+ * @param[in,out] interface : vof field and source terms
+ * @return                  : error code
+ */
+static int advect_vof(
     const domain_t * domain,
-    const size_t rkstep,
+    const double coef_a,
+    const double coef_b,
     const double dt,
+    const double * restrict ux,
+    const double * restrict uy,
     interface_t * interface
 ){
+  static tiling_t tiling = {
+    .name = "interface_update_vof",
+    .is_initialised = false,
+  };
+  bool x_grid_is_uniform = false;
+  domain_check_x_grid_is_uniform(domain, &x_grid_is_uniform);
   const int isize = domain->mysizes[0];
-  const int jsize = domain->mysizes[1];
-  double * restrict vof = interface->vof.data;
-  // update vof, alpha contribution | 19
-  {
-    const double coef = rkcoefs[rkstep][rk_a];
-    const double * restrict src = interface->src[rk_a].data;
-    for(int j = 1; j <= jsize; j++){
-      for(int i = 1; i <= isize; i++){
-        VOF(i, j) += dt * coef * SRC(i, j);
-      }
-    }
+  int size = isize;
+  if(0 != tiling_begin(domain, &tiling, &size)){
+    return 1;
   }
-  // update vof, beta contribution | 19
-  if(0 != rkstep){
-    const double coef = rkcoefs[rkstep][rk_b];
-    const double * restrict src = interface->src[rk_b].data;
-    for(int j = 1; j <= jsize; j++){
-      for(int i = 1; i <= isize; i++){
-        VOF(i, j) += dt * coef * SRC(i, j);
-      }
+  for(int is = 1; is <= isize; is += size){
+    const int ie = is + size - 1 < isize ? is + size - 1 : isize;
+    if(x_grid_is_uniform){
+      advect_vof_kernel(domain, true, coef_a, coef_b, dt, ux, uy, is, ie, interface);
+    }else{
+      advect_vof_kernel(domain, false, coef_a, coef_b, dt, ux, uy, is, ie, interface);
     }
   }
+  tiling_end(domain, &tiling);
   return 0;
 }
 
@@ -116,11 +259,69 @@ int interface_update_vof(
     const fluid_t * fluid,
     interface_t * interface
 ){
-  reset_srcs(rkstep, interface->src + rk_a, interface->src + rk_b);
-  compute_flux_x(domain, fluid, interface);
-  compute_flux_y(domain, fluid, interface);
-  interface_compute_rhs(domain, interface);
-  interface_advect_vof(domain, rkstep, dt, interface);
+  const double coef_a = rkcoefs[rkstep][rk_a];
+  const double coef_b = rkcoefs[rkstep][rk_b];
+  if(0 != advect_vof(domain, coef_a, coef_b, dt, fluid->ux.data, fluid->uy.data, interface)){
+    return 1;
+  }
+  interface_update_boundaries_vof(domain, &interface->vof);
+  return 0;
+}
+
+/**
+ * @brief store velocity at the beginning of a time step,
+ *          used when vof is advected once per step
+ * @param[in]     fluid     : velocity
+ * @param[in,out] interface : velocity buffers
+ * @return                  : error code
+ */
+int interface_store_velocity(
+    const fluid_t * fluid,
+    interface_t * interface
+){
+  memcpy(interface->ux.data, fluid->ux.data, fluid->ux.datasize);
+  memcpy(interface->uy.data, fluid->uy.data, fluid->uy.datasize);
+  return 0;
+}
+
+/**
+ * @brief advect vof field once per time step,
+ *          using velocity averaged over the step
+ * @param[in]     domain    : information about domain decomposition and size
+ * @param[in]     dt        : time step size
+ * @param[in]     fluid     : velocity at the end of the step
+ * @param[in,out] interface : velocity at the beginning of the step (in), vof field (out)
+ * @return                  : error code
+ */
+int interface_update_vof_once(
+    const domain_t * domain,
+    const double dt,
+    const fluid_t * fluid,
+    interface_t * interface
+){
+  // average velocity, including halo cells
+  {
+    const size_t nitems = fluid->ux.datasize / sizeof(double);
+    const double * restrict ux1 = fluid->ux.data;
+    double * restrict ux = interface->ux.data;
+    THREADS_PRAGMA(omp parallel for schedule(static))
+    for(size_t n = 0; n < nitems; n++){
+      ux[n] = 0.5 * (ux[n] + ux1[n]);
+    }
+  }
+  {
+    const size_t nitems = fluid->uy.datasize / sizeof(double);
+    const double * restrict uy1 = fluid->uy.data;
+    double * restrict uy = interface->uy.data;
+    THREADS_PRAGMA(omp parallel for schedule(static))
+    for(size_t n = 0; n < nitems; n++){
+      uy[n] = 0.5 * (uy[n] + uy1[n]);
+    }
+  }
+  // single-stage update with the frozen interface
+  if(0 != advect_vof(domain, 1., 0., dt, interface->ux.data, interface->uy.data, interface)){
+    return 1;
+  }
   interface_update_boundaries_vof(domain, &interface->vof);
   return 0;
 }
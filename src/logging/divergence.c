@@ -3,6 +3,7 @@
 #include "domain.h"
 #include "fluid.h"
 #include "fileio.h"
+#include "threads.h"
 #include "array_macros/domain/dxf.h"
 #include "array_macros/fluid/ux.h"
 #include "array_macros/fluid/uy.h"
@@ -34,6 +35,7 @@ int logging_check_divergence(
   const double * restrict ux = fluid->ux.data;
   const double * restrict uy = fluid->uy.data;
   double divmax = 0.;
+  THREADS_PRAGMA(omp parallel for schedule(static) reduction(max: divmax))
   for(int j = 1; j <= jsize; j++){
     for(int i = 1; i <= isize; i++){
       // compute local divergence
@@ -3,6 +3,7 @@
 #include "domain.h"
 #include "fluid.h"
 #include "fileio.h"
+#include "threads.h"
 #include "array_macros/domain/dxf.h"
 #include "array_macros/domain/dxc.h"
 #include "array_macros/fluid/ux.h"
@@ -40,6 +41,7 @@ int logging_check_energy(
   // velocity in each dimension and plus thermal energy
   double quantities[NDIMS + 1] = {0.};
   // compute quadratic quantity in x direction
+  THREADS_PRAGMA(omp parallel for schedule(static) reduction(+: quantities[:NDIMS + 1]))
   for(int j = 1; j <= jsize; j++){
     for(int i = 2; i <= isize; i++){
       const double dx = DXC(i  );
@@ -48,6 +50,7 @@ int logging_check_energy(
     }
   }
   // compute quadratic quantity in y direction
+  THREADS_PRAGMA(omp parallel for schedule(static) reduction(+: quantities[:NDIMS + 1]))
   for(int j = 1; j <= jsize; j++){
     for(int i = 1; i <= isize; i++){
       const double dx = DXF(i  );
@@ -56,6 +59,7 @@ int logging_check_energy(
     }
   }
   // compute thermal energy
+  THREADS_PRAGMA(omp parallel for schedule(static) reduction(+: quantities[:NDIMS + 1]))
   for(int j = 1; j <= jsize; j++){
     for(int i = 1; i <= isize; i++){
       const double dx = DXF(i  );
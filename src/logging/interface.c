@@ -1,8 +1,11 @@
 #include <stdio.h>
 #include <math.h>
+#include <float.h>
 #include "domain.h"
 #include "interface.h"
 #include "fileio.h"
+#include "threads.h"
+#include "array_macros/domain/xc.h"
 #include "array_macros/domain/dxf.h"
 #include "array_macros/interface/vof.h"
 #include "internal.h"
@@ -26,6 +29,7 @@ int logging_check_vof(
   double min = 1.;
   double max = 0.;
   double sums[2] = {0.};
+  THREADS_PRAGMA(omp parallel for schedule(static) reduction(min: min) reduction(max: max) reduction(+: sums[:2]))
   for(int j = 1; j <= jsize; j++){
     for(int i = 1; i <= isize; i++){
       const double dx = DXF(i  );
@@ -54,3 +58,95 @@ int logging_check_vof(
   return 0;
 }
 
+int logging_check_shape(
+    const char fname[],
+    const domain_t * domain,
+    const double time,
+    const interface_t * interface
+){
+  const int root = 0;
+  int myrank = root;
+  MPI_Comm comm_cart = MPI_COMM_NULL;
+  sdecomp.get_comm_rank(domain->info, &myrank);
+  sdecomp.get_comm_cart(domain->info, &comm_cart);
+  const int isize = domain->mysizes[0];
+  const int jsize = domain->mysizes[1];
+  const int joffset = domain->offsets[1];
+  const double * xc = domain->xc;
+  const double * dxf = domain->dxf;
+  const double dy = domain->dy;
+  const double * vof = interface->vof.data;
+  // zeroth, first, and second moments of the dispersed phase
+  // NOTE: y moments are meaningless
+  //   when the dispersed phase crosses the periodic boundary
+  double sums[5] = {0.};
+  THREADS_PRAGMA(omp parallel for schedule(static) reduction(+: sums[:5]))
+  for(int j = 1; j <= jsize; j++){
+    const double y = (joffset + j - 0.5) * dy;
+    for(int i = 1; i <= isize; i++){
+      const double x = XC(i  );
+      const double dx = DXF(i  );
+      const double lvol = VOF(i, j) * dx * dy;
+      sums[0] += lvol;
+      sums[1] += lvol * x;
+      sums[2] += lvol * y;
+      sums[3] += lvol * x * x;
+      sums[4] += lvol * y * y;
+    }
+  }
+  MPI_Allreduce(MPI_IN_PLACE, sums, 5, MPI_DOUBLE, MPI_SUM, comm_cart);
+  if(root == myrank){
+    FILE * fp = fileio.fopen(fname, "a");
+    if(NULL == fp){
+      return 0;
+    }
+    // centroid and standard deviation in each direction
+    const double vol = fmax(sums[0], DBL_MIN);
+    const double xg = sums[1] / vol;
+    const double yg = sums[2] / vol;
+    const double xd = sqrt(fmax(0., sums[3] / vol - xg * xg));
+    const double yd = sqrt(fmax(0., sums[4] / vol - yg * yg));
+    fprintf(fp, "%8.2f ", time);
+    fprintf(fp, "% 18.15e ", xg);
+    fprintf(fp, "% 18.15e ", yg);
+    fprintf(fp, "% 18.15e ", xd);
+    fprintf(fp, "% 18.15e\n", yd);
+    fileio.fclose(fp);
+  }
+  return 0;
+}
+
+int logging_check_intercept(
+    const char fname[],
+    const domain_t * domain,
+    const double time,
+    const interface_t * interface
+){
+  const int root = 0;
+  int myrank = root;
+  MPI_Comm comm_cart = MPI_COMM_NULL;
+  sdecomp.get_comm_rank(domain->info, &myrank);
+  sdecomp.get_comm_cart(domain->info, &comm_cart);
+  // number of Newton-Raphson iterations to find intercepts,
+  //   accumulated from the beginning
+  const int nbins = INTERFACE_NITERSMAX + 1;
+  unsigned long long niters[INTERFACE_NITERSMAX + 1] = {0};
+  for(int n = 0; n < nbins; n++){
+    niters[n] = interface->niters[n];
+  }
+  MPI_Allreduce(MPI_IN_PLACE, niters, nbins, MPI_UNSIGNED_LONG_LONG, MPI_SUM, comm_cart);
+  if(root == myrank){
+    FILE * fp = fileio.fopen(fname, "a");
+    if(NULL == fp){
+      return 0;
+    }
+    fprintf(fp, "%8.2f", time);
+    for(int n = 0; n < nbins; n++){
+      fprintf(fp, " %llu", niters[n]);
+    }
+    fprintf(fp, "\n");
+    fileio.fclose(fp);
+  }
+  return 0;
+}
+
@@ -42,4 +42,18 @@ extern int logging_check_vof(
     const interface_t * interface
 );
 
+extern int logging_check_shape(
+    const char fname[],
+    const domain_t * domain,
+    const double time,
+    const interface_t * interface
+);
+
+extern int logging_check_intercept(
+    const char fname[],
+    const domain_t * domain,
+    const double time,
+    const interface_t * interface
+);
+
 #endif // LOGGING_INTERNAL_H
@@ -101,6 +101,8 @@ static void check_and_output(
   logging_check_energy    ("output/log/energy.dat",     domain, time, fluid);
   logging_check_nusselt   ("output/log/nusselt.dat",    domain, time, fluid);
   logging_check_vof       ("output/log/vof.dat",        domain, time, interface);
+  logging_check_shape     ("output/log/shape.dat",      domain, time, interface);
+  logging_check_intercept ("output/log/intercept.dat",  domain, time, interface);
   g_next += g_rate;
 }
 
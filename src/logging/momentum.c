@@ -2,6 +2,7 @@
 #include "domain.h"
 #include "fluid.h"
 #include "fileio.h"
+#include "threads.h"
 #include "array_macros/domain/dxf.h"
 #include "array_macros/domain/dxc.h"
 #include "array_macros/fluid/ux.h"
@@ -36,6 +37,7 @@ int logging_check_momentum(
   const double * restrict uy = fluid->uy.data;
   double moms[NDIMS] = {0.};
   // compute total x-momentum
+  THREADS_PRAGMA(omp parallel for schedule(static) reduction(+: moms[:NDIMS]))
   for(int j = 1; j <= jsize; j++){
     for(int i = 2; i <= isize; i++){
       const double dx = DXC(i  );
@@ -44,6 +46,7 @@ int logging_check_momentum(
     }
   }
   // compute total y-momentum
+  THREADS_PRAGMA(omp parallel for schedule(static) reduction(+: moms[:NDIMS]))
   for(int j = 1; j <= jsize; j++){
     for(int i = 1; i <= isize; i++){
       const double dx = DXF(i  );
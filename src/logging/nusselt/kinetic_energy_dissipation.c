@@ -2,6 +2,7 @@
 #include <mpi.h>
 #include "domain.h"
 #include "fluid.h"
+#include "threads.h"
 #include "array_macros/domain/dxf.h"
 #include "array_macros/domain/dxc.h"
 #include "array_macros/fluid/ux.h"
@@ -20,6 +21,7 @@ static double get_ux_x_contribution(
   const double * restrict ux = fluid->ux.data;
   const double diffusivity = fluid->m_dif;
   double dissipation = 0.;
+  THREADS_PRAGMA(omp parallel for schedule(static) reduction(+: dissipation))
   for(int j = 1; j <= jsize; j++){
     for(int i = 1; i <= isize + 1; i++){
       // ux-x contribution
@@ -52,6 +54,7 @@ static double get_ux_y_contribution(
   const double * restrict ux = fluid->ux.data;
   const double diffusivity = fluid->m_dif;
   double dissipation = 0.;
+  THREADS_PRAGMA(omp parallel for schedule(static) reduction(+: dissipation))
   for(int j = 1; j <= jsize; j++){
     for(int i = 1; i <= isize + 1; i++){
       // ux-y contribution
@@ -84,6 +87,7 @@ static double get_uy_x_contribution(
   const double * restrict uy = fluid->uy.data;
   const double diffusivity = fluid->m_dif;
   double dissipation = 0.;
+  THREADS_PRAGMA(omp parallel for schedule(static) reduction(+: dissipation))
   for(int j = 1; j <= jsize; j++){
     for(int i = 1; i <= isize; i++){
       // uy-x contribution
@@ -118,6 +122,7 @@ static double get_uy_y_contribution(
   const double * restrict uy = fluid->uy.data;
   const double diffusivity = fluid->m_dif;
   double dissipation = 0.;
+  THREADS_PRAGMA(omp parallel for schedule(static) reduction(+: dissipation))
   for(int j = 1; j <= jsize; j++){
     for(int i = 1; i <= isize; i++){
       // uy-y contribution
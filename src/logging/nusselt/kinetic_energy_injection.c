@@ -1,6 +1,7 @@
 #include <mpi.h>
 #include "domain.h"
 #include "fluid.h"
+#include "threads.h"
 #include "array_macros/domain/dxc.h"
 #include "array_macros/fluid/ux.h"
 #include "array_macros/fluid/t.h"
@@ -29,6 +30,7 @@ double logging_internal_compute_nu_kinetic_energy_injection(
   const double ref = logging_internal_compute_reference_heat_flux(domain, fluid);
   // integral in the whole domain
   double retval = 0.;
+  THREADS_PRAGMA(omp parallel for schedule(static) reduction(+: retval))
   for(int j = 1; j <= jsize; j++){
     for(int i = 2; i <= isize; i++){
       const double dx = DXC(i  );
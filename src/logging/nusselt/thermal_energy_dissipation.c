@@ -2,6 +2,7 @@
 #include <mpi.h>
 #include "domain.h"
 #include "fluid.h"
+#include "threads.h"
 #include "array_macros/domain/dxf.h"
 #include "array_macros/domain/dxc.h"
 #include "array_macros/fluid/t.h"
@@ -19,6 +20,7 @@ static double get_x_contribution(
   const double * restrict t = fluid->t.data;
   const double diffusivity = fluid->t_dif;
   double dissipation = 0.;
+  THREADS_PRAGMA(omp parallel for schedule(static) reduction(+: dissipation))
   for(int j = 1; j <= jsize; j++){
     for(int i = 1; i <= isize; i++){
       // x contribution
@@ -53,6 +55,7 @@ static double get_y_contribution(
   const double * restrict t = fluid->t.data;
   const double diffusivity = fluid->t_dif;
   double dissipation = 0.;
+  THREADS_PRAGMA(omp parallel for schedule(static) reduction(+: dissipation))
   for(int j = 1; j <= jsize; j++){
     for(int i = 1; i <= isize; i++){
       // y contribution
@@ -2,6 +2,7 @@
 #include <mpi.h>
 #include "memory.h"
 #include "timer.h"
+#include "threads.h"
 #include "domain.h"
 #include "fluid.h"
 #include "fluid_solver.h"
@@ -43,11 +44,22 @@ int main(
     char * argv[]
 ){
   // launch MPI, start timer
-  MPI_Init(NULL, NULL);
+  // NOTE: MPI functions are only called by the main thread
+  int provided = MPI_THREAD_SINGLE;
+  MPI_Init_thread(NULL, NULL, MPI_THREAD_FUNNELED, &provided);
   const int root = 0;
   int myrank = root;
   MPI_Comm_rank(MPI_COMM_WORLD, &myrank);
   const double tic = timer();
+  if(MPI_THREAD_FUNNELED > provided){
+    if(root == myrank){
+      printf("MPI_THREAD_FUNNELED is not supported\n");
+    }
+    goto abort;
+  }
+  if(0 != threads_init()){
+    goto abort;
+  }
   // find name of directory where IC is stored
   if(2 != argc){
     if(root == myrank){
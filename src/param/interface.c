@@ -0,0 +1,9 @@
+#include "param.h"
+
+const bool param_interface_reuse_exponentials = true;
+
+const bool param_interface_once_per_step = false;
+
+const bool param_interface_warm_start        = false;
+const bool param_interface_closed_form_guess = true;
+
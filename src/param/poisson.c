@@ -0,0 +1,7 @@
+#include "param.h"
+
+const int param_poisson_nbatches = 4;
+
+const double param_poisson_mg_tolerance = 1.e-12;
+
+const int param_poisson_mg_maxcycles = 100;
@@ -0,0 +1,4 @@
+#include "param.h"
+
+const bool param_predict_combined_rhs = false;
+
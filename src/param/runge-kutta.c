@@ -0,0 +1,4 @@
+#include "param.h"
+
+const bool param_rk_low_storage = false;
+
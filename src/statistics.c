@@ -9,6 +9,7 @@
 #include "statistics.h"
 #include "fileio.h"
 #include "config.h"
+#include "threads.h"
 #include "array_macros/fluid/ux.h"
 #include "array_macros/fluid/uy.h"
 #include "array_macros/fluid/t.h"
@@ -122,6 +123,7 @@ static void collect_mean_ux(
   const int jsize = domain->mysizes[1];
   double * restrict ux1 = g_ux1.data;
   double * restrict ux2 = g_ux2.data;
+  THREADS_PRAGMA(omp parallel for schedule(static))
   for(int j = 1; j <= jsize; j++){
     for(int i = 1; i <= isize + 1; i++){
       UX1(i, j) += pow(UX(i, j), 1.);
@@ -143,6 +145,7 @@ static void collect_mean_uy(
   const int jsize = domain->mysizes[1];
   double * restrict uy1 = g_uy1.data;
   double * restrict uy2 = g_uy2.data;
+  THREADS_PRAGMA(omp parallel for schedule(static))
   for(int j = 1; j <= jsize; j++){
     for(int i = 0; i <= isize + 1; i++){
       UY1(i, j) += pow(UY(i, j), 1.);
@@ -165,6 +168,7 @@ static void collect_mean_t(
   const int jsize = domain->mysizes[1];
   double * restrict t1 = g_t1.data;
   double * restrict t2 = g_t2.data;
+  THREADS_PRAGMA(omp parallel for schedule(static))
   for(int j = 1; j <= jsize; j++){
     for(int i = 0; i <= isize + 1; i++){
       T1(i, j) += pow(T(i, j), 1.);
@@ -187,6 +191,7 @@ static void collect_uxt(
   const int isize = domain->mysizes[0];
   const int jsize = domain->mysizes[1];
   double * restrict uxt = g_uxt.data;
+  THREADS_PRAGMA(omp parallel for schedule(static))
   for(int j = 1; j <= jsize; j++){
     for(int i = 1; i <= isize + 1; i++){
       const double t_ =
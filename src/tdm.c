@@ -3,104 +3,262 @@
 #include <complex.h>
 #include <fftw3.h>
 #include "memory.h"
+#include "threads.h"
 #include "tdm.h"
 
+// number of systems solved at once by the vectorised kernels,
+//   whose right-hand-sides are interleaved
+//   so that the innermost loops run over the independent systems
+#define NLANES 8
+
+// definition of tdm_factor_t_
 /**
- * @brief kernel function to solve a linear system
- * @param[in]    n : matrix size
- * @param[in]    l : lower  diagonal part
- * @param[in]    c : center diagonal part
- * @param[in]    u : upper  diagonal part
- * @param[inout] q : right-hand-side & answers
- * @return         : error code
+ * @struct tdm_factor_t_
+ * @brief LU factorisation of a tri-diagonal matrix,
+ *          which depends only on the matrix and thus can be re-used
+ *          as long as the matrix is unchanged
+ * @var size        : size of the system
+ * @var is_periodic : periodic boundary condition is imposed or not
+ * @var c0          : first center-diagonal component
+ * @var l           : copy of lower-diagonal components
+ * @var v           : updated upper-diagonal components
+ * @var d           : reciprocals of the pivots
+ * @var is_singular : last pivot vanishes (zero mean is imposed) or not
+ * @var u1          : last upper-diagonal component (periodic only)
+ * @var q1          : solution of the additional system (periodic only)
+ * @var den         : denominator of the Sherman-Morrison formula (periodic only)
+ */
+struct tdm_factor_t_ {
+  int size;
+  bool is_periodic;
+  double c0;
+  double * restrict l;
+  double * restrict v;
+  double * restrict d;
+  bool is_singular;
+  double u1;
+  double * restrict q1;
+  double den;
+};
+
+/**
+ * @brief kernel function to solve a factorised linear system
+ * @param[in]    n      : matrix size
+ * @param[in]    f      : factorisation
+ * @param[in]    stride : distance between two consecutive elements
+ * @param[inout] q      : right-hand-side & answers,
+ *                          q[i * stride] is the i-th element
+ * @return              : error code
  */
 #define GTSV(type) \
   static int gtsv_##type( \
       const int n, \
-      const double * restrict l, \
-      const double * restrict c, \
-      const double * restrict u, \
-      double * restrict v, \
+      const tdm_factor_t * f, \
+      const size_t stride, \
       type * restrict q \
 ){ \
-    /* divide the first row by center-diagonal term | 2 */ \
-    v[0] = u[0] / c[0]; \
-    q[0] = q[0] / c[0]; \
-    /* forward substitution | 7 */ \
+    const double * restrict l = f->l; \
+    const double * restrict v = f->v; \
+    const double * restrict d = f->d; \
+    /* divide the first row by center-diagonal term */ \
+    q[0] = q[0] / f->c0; \
+    /* forward substitution */ \
     for(int i = 1; i < n - 1; i++){ \
-      /* assume positive-definite system */ \
-      /*   to skip zero-division checks */ \
-      double val = 1. / (c[i] - l[i] * v[i-1]); \
-      v[i] = val *      (u[i]                ); \
-      q[i] = val *      (q[i] - l[i] * q[i-1]); \
+      q[stride*i] = d[i] * (q[stride*i] - l[i] * q[stride*(i-1)]); \
     } \
-    /* last row, do the same thing but consider singularity | 7 */ \
-    double val = c[n-1] - l[n-1] * v[n-2]; \
-    if(fabs(val) > DBL_EPSILON){ \
-      q[n-1] = 1. / val * (q[n-1] - l[n-1] * q[n-2]); \
-    }else{ \
-      /* singular, zero mean */ \
-      q[n-1] = 0.; \
+    /* last row, singular system has zero mean */ \
+    q[stride*(n-1)] = f->is_singular ? 0. : d[n-1] * (q[stride*(n-1)] - l[n-1] * q[stride*(n-2)]); \
+    /* backward substitution */ \
+    for(int i = n - 2; i >= 0; i--){ \
+      q[stride*i] -= v[i] * q[stride*(i+1)]; \
+    } \
+    return 0; \
+  }
+
+/**
+ * @brief kernel function to solve NLANES factorised linear systems sharing the matrix,
+ *          which is identical to GTSV for each system
+ * @param[in]    n      : matrix size
+ * @param[in]    f      : factorisation
+ * @param[in]    stride : distance between two consecutive elements of a system
+ * @param[inout] q      : interleaved right-hand-sides & answers,
+ *                          q[i * stride + k] is the i-th element of the k-th system
+ * @return              : error code
+ */
+#define GTSV_LANES(type) \
+  static int gtsv_lanes_##type( \
+      const int n, \
+      const tdm_factor_t * f, \
+      const size_t stride, \
+      type * restrict q \
+){ \
+    const double * restrict l = f->l; \
+    const double * restrict v = f->v; \
+    const double * restrict d = f->d; \
+    /* divide the first row by center-diagonal term */ \
+    for(int k = 0; k < NLANES; k++){ \
+      q[k] = q[k] / f->c0; \
+    } \
+    /* forward substitution */ \
+    for(int i = 1; i < n - 1; i++){ \
+      type       * restrict q0 = q + stride * (i    ); \
+      const type * restrict qm = q + stride * (i - 1); \
+      for(int k = 0; k < NLANES; k++){ \
+        q0[k] = d[i] * (q0[k] - l[i] * qm[k]); \
+      } \
+    } \
+    /* last row, singular system has zero mean */ \
+    type       * restrict q0 = q + stride * (n - 1); \
+    const type * restrict qm = q + stride * (n - 2); \
+    for(int k = 0; k < NLANES; k++){ \
+      q0[k] = f->is_singular ? 0. : d[n-1] * (q0[k] - l[n-1] * qm[k]); \
     } \
-    /* backward substitution | 3 */ \
+    /* backward substitution */ \
     for(int i = n - 2; i >= 0; i--){ \
-      q[i] -= v[i] * q[i+1]; \
+      type       * restrict q0 = q + stride * (i    ); \
+      const type * restrict qp = q + stride * (i + 1); \
+      for(int k = 0; k < NLANES; k++){ \
+        q0[k] -= v[i] * qp[k]; \
+      } \
     } \
     return 0; \
   }
 
 /**
- * @brief solve linear system
- * @param[in]    n           : size of tri-diagonal matrix
- * @param[in]    m           : how many right-hand-sides do you want to solve?
- * @param[in]    is_periodic : periodic boundary condition is imposed
- *                               (Sherman-Morrison formula is used)
- *                               or not (normal Thomas algorithm is used)
- * @param[in]    l           : pointer to lower- diagonal components
- * @param[in]    c           : pointer to center-diagonal components
- * @param[in]    u           : pointer to upper- diagonal components
- * @param[inout] q           : right-hand-sides (size: "n", repeat for "m" times) & answers
- *                               N.B. memory is contiguous in "n" direction, sparse in "m" direction
- * @return                   : error code
+ * @brief interleave (and de-interleave) NLANES right-hand-sides
+ * @param[in]    n : size of each system
+ * @param[in]    q : right-hand-sides, contiguous in "n" direction
+ * @param[out]   w : interleaved right-hand-sides
+ * @return         : error code
  */
-#define TDM_SOLVE(type) \
-  static int tdm_solve_##type( \
+#define PACK(type) \
+  static int pack_##type( \
       const int n, \
-      const int nrhs, \
-      const bool is_periodic, \
-      const double * restrict l, \
-      const double * restrict c, \
-      const double * restrict u, \
-      double * restrict v, \
-      type * restrict q, \
-      double * restrict q1 \
+      const type * restrict q, \
+      type * restrict w \
 ){ \
-    if(is_periodic){ \
-      /* solve additional system coming from periodicity | 7 */ \
+    for(int k = 0; k < NLANES; k++){ \
+      for(int i = 0; i < n; i++){ \
+        w[i * NLANES + k] = q[k * n + i]; \
+      } \
+    } \
+    return 0; \
+  } \
+  static int unpack_##type( \
+      const int n, \
+      const type * restrict w, \
+      type * restrict q \
+){ \
+    for(int k = 0; k < NLANES; k++){ \
+      for(int i = 0; i < n; i++){ \
+        q[k * n + i] = w[i * NLANES + k]; \
+      } \
+    } \
+    return 0; \
+  }
+
+/**
+ * @brief solve linear systems using the factorisation
+ * @param[in]    n    : size of tri-diagonal matrix
+ * @param[in]    nrhs : how many right-hand-sides do you want to solve?
+ * @param[in]    f    : factorisation of the matrix
+ * @param[out]   w    : interleaved right-hand-sides, one set per thread
+ * @param[inout] q    : right-hand-sides (size: "n", repeat for "nrhs" times) & answers
+ *                        N.B. memory is contiguous in "n" direction, sparse in "nrhs" direction
+ * @return            : error code
+ */
+#define TDM_SOLVE(type) \
+  static int solve_system_##type( \
+      const int n, \
+      const tdm_factor_t * f, \
+      const size_t stride, \
+      type * restrict q \
+  ){ \
+    if(f->is_periodic){ \
+      /* solve normal system */ \
+      gtsv_##type(n-1, f, stride, q); \
+      /* find x_{n-1} */ \
+      type   num = q[stride*(n-1)] - f->u1 * q[0] - f->l[n-1] * q[stride*(n-2)]; \
+      q[stride*(n-1)] = fabs(f->den) < DBL_EPSILON ? 0. : num / f->den; \
+      /* solve original system */ \
       for(int i = 0; i < n-1; i++){ \
-        q1[i] \
-          = i ==   0 ? -l[i] \
-          : i == n-2 ? -u[i] \
-          : 0.; \
+        q[stride*i] = q[stride*i] + q[stride*(n-1)] * f->q1[i]; \
       } \
-      gtsv_double(n-1, l, c, u, v, q1); \
-      for(int j = 0; j < nrhs; j++){ \
-        /* solve normal system | 2 */ \
-        type *q0 = q + j * n; \
-        gtsv_##type(n-1, l, c, u, v, q0); \
-        /* find x_{n-1} | 3 */ \
-        type   num = q0[n-1] - u[n-1] * q0[0] - l[n-1] * q0[n-2]; \
-        double den = c [n-1] + u[n-1] * q1[0] + l[n-1] * q1[n-2]; \
-        q0[n-1] = fabs(den) < DBL_EPSILON ? 0. : num / den; \
-        /* solve original system | 3 */ \
-        for(int i = 0; i < n-1; i++){ \
-          q0[i] = q0[i] + q0[n-1] * q1[i]; \
+    }else{ \
+      gtsv_##type(n, f, stride, q); \
+    } \
+    return 0; \
+  } \
+  static int solve_lanes_##type( \
+      const int n, \
+      const tdm_factor_t * f, \
+      const size_t stride, \
+      type * restrict w \
+  ){ \
+    if(f->is_periodic){ \
+      /* solve normal system */ \
+      gtsv_lanes_##type(n-1, f, stride, w); \
+      /* find x_{n-1} */ \
+      type       * restrict w0 = w + stride * (n - 1); \
+      const type * restrict wf = w; \
+      const type * restrict wm = w + stride * (n - 2); \
+      for(int k = 0; k < NLANES; k++){ \
+        type num = w0[k] - f->u1 * wf[k] - f->l[n-1] * wm[k]; \
+        w0[k] = fabs(f->den) < DBL_EPSILON ? 0. : num / f->den; \
+      } \
+      /* solve original system */ \
+      for(int i = 0; i < n-1; i++){ \
+        type * restrict wi = w + stride * i; \
+        for(int k = 0; k < NLANES; k++){ \
+          wi[k] = wi[k] + w0[k] * f->q1[i]; \
         } \
       } \
     }else{ \
-      for(int j = 0; j < nrhs; j++){ \
-        gtsv_##type(n, l, c, u, v, q + j * n); \
-      } \
+      gtsv_lanes_##type(n, f, stride, w); \
+    } \
+    return 0; \
+  } \
+  static int tdm_solve_##type( \
+      const int n, \
+      const int nrhs, \
+      const tdm_factor_t * f, \
+      type * restrict w, \
+      type * restrict q \
+){ \
+    /* independent systems are solved NLANES by NLANES, */ \
+    /*   and the batches are distributed to threads */ \
+    const int nbatches = nrhs / NLANES; \
+    THREADS_PRAGMA(omp parallel for schedule(static)) \
+    for(int b = 0; b < nbatches; b++){ \
+      type * wb = w + n * NLANES * threads_get_mythread(); \
+      type * qb = q + n * NLANES * b; \
+      pack_##type(n, qb, wb); \
+      solve_lanes_##type(n, f, NLANES, wb); \
+      unpack_##type(n, wb, qb); \
+    } \
+    /* remainders are solved one by one */ \
+    for(int j = NLANES * nbatches; j < nrhs; j++){ \
+      solve_system_##type(n, f, 1, q + j * n); \
+    } \
+    return 0; \
+  } \
+  static int tdm_solve_strided_##type( \
+      const int n, \
+      const int nrhs, \
+      const size_t stride, \
+      const tdm_factor_t * f, \
+      type * restrict q \
+){ \
+    /* neighbouring systems are already interleaved, */ \
+    /*   which are solved in place NLANES by NLANES */ \
+    const int nbatches = nrhs / NLANES; \
+    THREADS_PRAGMA(omp parallel for schedule(static)) \
+    for(int b = 0; b < nbatches; b++){ \
+      solve_lanes_##type(n, f, stride, q + NLANES * b); \
+    } \
+    /* remainders are solved one by one */ \
+    for(int j = NLANES * nbatches; j < nrhs; j++){ \
+      solve_system_##type(n, f, stride, q + j); \
     } \
     return 0; \
   }
@@ -108,6 +266,10 @@
 // expand macros to define solvers
 GTSV(double)
 GTSV(fftw_complex)
+GTSV_LANES(double)
+GTSV_LANES(fftw_complex)
+PACK(double)
+PACK(fftw_complex)
 TDM_SOLVE(double)
 TDM_SOLVE(fftw_complex)
 
@@ -120,8 +282,8 @@ TDM_SOLVE(fftw_complex)
  * @var is_periodic  : periodic boundary condition is imposed or not
  * @var is_complex   : data type of the right-hand-side terms is fftw_complex or not (double)
  * @var l, c, u      : lower, center and upper-diagonal parts of the system
- * @var v            : internal buffer (updated "u" is stored)
- * @var q1           : internal buffer (additional right-hand-side term to be solved in addition to "q" is stored)
+ * @var w            : internal buffers, one per thread (interleaved right-hand-sides are stored)
+ * @var factor       : internal factorisation, used when the matrix is factorised every time
  */
 struct tdm_info_t_ {
   int size;
@@ -131,8 +293,8 @@ struct tdm_info_t_ {
   double * restrict l;
   double * restrict c;
   double * restrict u;
-  double * restrict v;
-  double * restrict q1;
+  void * restrict w;
+  tdm_factor_t * factor;
 };
 
 /**
@@ -173,12 +335,13 @@ static int construct(
   (*info)->l = memory_calloc(size, sizeof(double));
   (*info)->c = memory_calloc(size, sizeof(double));
   (*info)->u = memory_calloc(size, sizeof(double));
-  (*info)->v = memory_calloc(size, sizeof(double));
-  if(is_periodic && /* to avoid zero-size allocation */ 1 < size){
-    (*info)->q1 = memory_calloc(size - 1, sizeof(double));
+  // interleaved buffers are only needed to solve NLANES systems at once
+  if(NLANES <= nrhs){
+    (*info)->w = memory_calloc((size_t)size * NLANES * threads_get_nthreads(), is_complex ? sizeof(fftw_complex) : sizeof(double));
   }else{
-    (*info)->q1 = NULL;
+    (*info)->w = NULL;
   }
+  (*info)->factor = NULL;
   return 0;
 }
 
@@ -261,33 +424,174 @@ static int get_nrhs(
 }
 
 /**
- * @brief solve tri-diagonal systems for the given input
- * @param[in]     info : initialised by constructor
- * @param[in,out] data : pointer to the right-hand-side terms, also used as a place to store the result
- * @return             : error code
+ * @brief factorise the current matrix
+ * @param[in]     info   : initialised by constructor, whose l, c and u are given
+ * @param[in,out] factor : factorisation, allocated if NULL is given
+ * @return               : error code
  */
-static int solve(
+static int factorise(
     const tdm_info_t * info,
-    void * restrict data
+    tdm_factor_t ** factor
 ){
   if(NULL == info){
     printf("ERROR(%s): info is NULL\n", __func__);
     return 1;
   }
-  const int size = info->size;
-  const int nrhs = info->nrhs;
+  const int n = info->size;
   const bool is_periodic = info->is_periodic;
-  const bool is_complex  = info->is_complex;
   const double * restrict l = info->l;
   const double * restrict c = info->c;
   const double * restrict u = info->u;
-  double * restrict v  = info->v;
-  double * restrict q1 = info->q1;
-  if(is_complex){
-    tdm_solve_fftw_complex(size, nrhs, is_periodic, l, c, u, v, data, q1);
+  if(NULL == *factor){
+    *factor = memory_calloc(1, sizeof(tdm_factor_t));
+    (*factor)->l = memory_calloc(n, sizeof(double));
+    (*factor)->v = memory_calloc(n, sizeof(double));
+    (*factor)->d = memory_calloc(n, sizeof(double));
+    if(is_periodic && /* to avoid zero-size allocation */ 1 < n){
+      (*factor)->q1 = memory_calloc(n - 1, sizeof(double));
+    }else{
+      (*factor)->q1 = NULL;
+    }
+  }
+  tdm_factor_t * f = *factor;
+  f->size = n;
+  f->is_periodic = is_periodic;
+  // periodic systems are reduced to the first n-1 rows
+  //   by the Sherman-Morrison formula
+  const int m = is_periodic ? n - 1 : n;
+  // forward elimination, which does not depend on the right-hand-sides
+  double * restrict v = f->v;
+  double * restrict d = f->d;
+  for(int i = 0; i < n; i++){
+    f->l[i] = l[i];
+  }
+  f->c0 = c[0];
+  v[0] = u[0] / c[0];
+  for(int i = 1; i < m - 1; i++){
+    // assume positive-definite system
+    //   to skip zero-division checks
+    d[i] = 1. / (c[i] - l[i] * v[i-1]);
+    v[i] = d[i] * (u[i]);
+  }
+  // last row, do the same thing but consider singularity
+  const double val = c[m-1] - l[m-1] * v[m-2];
+  f->is_singular = !(fabs(val) > DBL_EPSILON);
+  d[m-1] = f->is_singular ? 0. : 1. / val;
+  if(is_periodic){
+    // solve additional system coming from periodicity
+    double * restrict q1 = f->q1;
+    for(int i = 0; i < n-1; i++){
+      q1[i]
+        = i ==   0 ? -l[i]
+        : i == n-2 ? -u[i]
+        : 0.;
+    }
+    gtsv_double(n-1, f, 1, q1);
+    f->u1  = u[n-1];
+    f->den = c [n-1] + u[n-1] * q1[0] + l[n-1] * q1[n-2];
+  }
+  return 0;
+}
+
+/**
+ * @brief solve tri-diagonal systems using the given factorisation
+ * @param[in]     info   : initialised by constructor
+ * @param[in]     factor : factorisation of the matrix
+ * @param[in,out] data   : pointer to the right-hand-side terms, also used as a place to store the result
+ * @return               : error code
+ */
+static int solve_factorised(
+    const tdm_info_t * info,
+    const tdm_factor_t * factor,
+    void * restrict data
+){
+  if(NULL == info || NULL == factor){
+    printf("ERROR(%s): info or factor is NULL\n", __func__);
+    return 1;
+  }
+  const int size = info->size;
+  const int nrhs = info->nrhs;
+  if(info->is_complex){
+    tdm_solve_fftw_complex(size, nrhs, factor, info->w, data);
+  }else{
+    tdm_solve_double(size, nrhs, factor, info->w, data);
+  }
+  return 0;
+}
+
+/**
+ * @brief solve tri-diagonal systems using the given factorisation,
+ *          whose right-hand-side terms are interleaved,
+ *          e.g. columns of an x1 pencil solved in y without transposing it
+ * @param[in]     info   : initialised by constructor
+ * @param[in]     factor : factorisation of the matrix
+ * @param[in]     stride : distance between two consecutive elements of a system,
+ *                           which should not be smaller than the number of right-hand-sides
+ * @param[in,out] data   : pointer to the right-hand-side terms, also used as a place to store the result
+ *                           the i-th element of the m-th system is data[i * stride + m]
+ * @return               : error code
+ */
+static int solve_factorised_strided(
+    const tdm_info_t * info,
+    const tdm_factor_t * factor,
+    const size_t stride,
+    void * restrict data
+){
+  if(NULL == info || NULL == factor){
+    printf("ERROR(%s): info or factor is NULL\n", __func__);
+    return 1;
+  }
+  const int size = info->size;
+  const int nrhs = info->nrhs;
+  if(stride < (size_t)nrhs){
+    printf("ERROR(%s): stride (%zu) is smaller than nrhs (%d)\n", __func__, stride, nrhs);
+    return 1;
+  }
+  if(info->is_complex){
+    tdm_solve_strided_fftw_complex(size, nrhs, stride, factor, data);
   }else{
-    tdm_solve_double(size, nrhs, is_periodic, l, c, u, v, data, q1);
+    tdm_solve_strided_double(size, nrhs, stride, factor, data);
+  }
+  return 0;
+}
+
+/**
+ * @brief solve tri-diagonal systems for the given input,
+ *          factorising the current matrix
+ * @param[in]     info : initialised by constructor
+ * @param[in,out] data : pointer to the right-hand-side terms, also used as a place to store the result
+ * @return             : error code
+ */
+static int solve(
+    tdm_info_t * info,
+    void * restrict data
+){
+  if(NULL == info){
+    printf("ERROR(%s): info is NULL\n", __func__);
+    return 1;
+  }
+  if(0 != factorise(info, &info->factor)){
+    return 1;
+  }
+  return solve_factorised(info, info->factor, data);
+}
+
+/**
+ * @brief deallocate factorisation
+ * @param[in] factor : factorisation
+ * @return           : error code
+ */
+static int destruct_factor(
+    tdm_factor_t * factor
+){
+  if(NULL == factor){
+    return 0;
   }
+  memory_free(factor->l);
+  memory_free(factor->v);
+  memory_free(factor->d);
+  memory_free(factor->q1);
+  memory_free(factor);
   return 0;
 }
 
@@ -306,20 +610,24 @@ static int destruct(
   memory_free(info->l);
   memory_free(info->c);
   memory_free(info->u);
-  memory_free(info->v);
-  memory_free(info->q1);
+  memory_free(info->w);
+  destruct_factor(info->factor);
   memory_free(info);
   return 0;
 }
 
 const tdm_t tdm = {
-  .construct = construct,
-  .get_l     = get_l,
-  .get_c     = get_c,
-  .get_u     = get_u,
-  .get_size  = get_size,
-  .get_nrhs  = get_nrhs,
-  .solve     = solve,
-  .destruct  = destruct,
+  .construct                = construct,
+  .get_l                    = get_l,
+  .get_c                    = get_c,
+  .get_u                    = get_u,
+  .get_size                 = get_size,
+  .get_nrhs                 = get_nrhs,
+  .factorise                = factorise,
+  .solve_factorised         = solve_factorised,
+  .solve_factorised_strided = solve_factorised_strided,
+  .solve                    = solve,
+  .destruct_factor          = destruct_factor,
+  .destruct                 = destruct,
 };
 
@@ -0,0 +1,66 @@
+#include <stdio.h>
+#include <mpi.h>
+#include <fftw3.h>
+#if defined(_OPENMP)
+#include <omp.h>
+#endif
+#include "threads.h"
+
+// the solver is built with or without OpenMP,
+//   the latter of which is pure MPI with one thread per process
+// NOTE: MPI is only called from the main thread outside parallel regions,
+//   which is ensured by MPI_THREAD_FUNNELED
+
+/**
+ * @brief initialise threading, which is called once after MPI is launched
+ * @return : error code
+ */
+int threads_init(
+    void
+){
+#if defined(_OPENMP)
+  // FFTW plans created hereafter are executed by threads
+  if(0 == fftw_init_threads()){
+    fprintf(stderr, "fftw_init_threads failed\n");
+    return 1;
+  }
+#endif
+  const int root = 0;
+  int myrank = root;
+  MPI_Comm_rank(MPI_COMM_WORLD, &myrank);
+  if(root == myrank){
+    printf("THREADS\n");
+    printf("\tnthreads: %d\n", threads_get_nthreads());
+    fflush(stdout);
+  }
+  return 0;
+}
+
+/**
+ * @brief number of threads which work in parallel regions
+ * @return : number of threads
+ */
+int threads_get_nthreads(
+    void
+){
+#if defined(_OPENMP)
+  return omp_get_max_threads();
+#else
+  return 1;
+#endif
+}
+
+/**
+ * @brief index of the calling thread
+ * @return : thread index, [0 : nthreads - 1]
+ */
+int threads_get_mythread(
+    void
+){
+#if defined(_OPENMP)
+  return omp_get_thread_num();
+#else
+  return 0;
+#endif
+}
+
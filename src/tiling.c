@@ -0,0 +1,155 @@
+#include <stdio.h>
+#include <float.h>
+#include "config.h"
+#include "timer.h"
+#include "domain.h"
+#include "tiling.h"
+
+// number of sweeps timed per candidate,
+//   the shortest of which is adopted
+#define NSAMPLES 4
+// power-of-two candidates which are examined
+//   in addition to the whole rows
+#define SIZEMAX 1024
+#define SIZEMIN 32
+
+// tile size given by the user, which is common for all sequences,
+//   0 to tune each sequence automatically
+static bool g_is_loaded = false;
+static int g_size = 0;
+
+static int load_size(
+    void
+){
+  double value = 0.;
+  if(0 != config.get_double("tile_size", &value)){
+    return 1;
+  }
+  g_size = value < 1. ? 0 : (int)value;
+  g_is_loaded = true;
+  return 0;
+}
+
+static int init(
+    const domain_t * domain,
+    tiling_t * tiling
+){
+  if(!g_is_loaded){
+    if(0 != load_size()){
+      return 1;
+    }
+  }
+  const int isize = domain->mysizes[0];
+  if(0 < g_size){
+    // fixed by the user
+    tiling->size = g_size < isize ? g_size : isize;
+    tiling->is_tuning = false;
+  }else{
+    // whole rows (no tiling) first,
+    //   followed by the powers of two which are smaller
+    size_t ncands = 0;
+    tiling->cands[ncands++] = isize;
+    for(int size = SIZEMAX; SIZEMIN <= size; size /= 2){
+      if(size < isize){
+        tiling->cands[ncands++] = size;
+      }
+    }
+    for(size_t n = 0; n < ncands; n++){
+      tiling->wtimes[n] = DBL_MAX;
+    }
+    tiling->ncands = ncands;
+    tiling->cand = 0;
+    tiling->nsamples = 0;
+    tiling->size = tiling->cands[0];
+    tiling->is_tuning = true;
+  }
+  tiling->is_initialised = true;
+  return 0;
+}
+
+static int report(
+    const domain_t * domain,
+    const tiling_t * tiling
+){
+  const int root = 0;
+  int myrank = root;
+  sdecomp.get_comm_rank(domain->info, &myrank);
+  if(root == myrank){
+    printf("TILING (%s)\n", tiling->name);
+    for(size_t n = 0; n < tiling->ncands; n++){
+      printf("\t%5d: % .3e\n", tiling->cands[n], tiling->wtimes[n]);
+    }
+    printf("\tadopted: %d\n", tiling->size);
+    fflush(stdout);
+  }
+  return 0;
+}
+
+/**
+ * @brief give the tile size of this sweep
+ * @param[in]     domain : information about domain decomposition and size
+ * @param[in,out] tiling : tiling of the kernel sequence
+ * @param[out]    size   : number of cells in x per tile
+ * @return               : error code
+ */
+int tiling_begin(
+    const domain_t * domain,
+    tiling_t * tiling,
+    int * size
+){
+  if(!tiling->is_initialised){
+    if(0 != init(domain, tiling)){
+      return 1;
+    }
+  }
+  if(tiling->is_tuning){
+    // NOTE: timer returns the time of the main process
+    //   and thus all processes end up with the same choice
+    tiling->size = tiling->cands[tiling->cand];
+    tiling->tic = timer();
+  }
+  *size = tiling->size;
+  return 0;
+}
+
+/**
+ * @brief finish the sweep, which is timed when autotuning
+ * @param[in]     domain : information about domain decomposition and size
+ * @param[in,out] tiling : tiling of the kernel sequence
+ * @return               : error code
+ */
+int tiling_end(
+    const domain_t * domain,
+    tiling_t * tiling
+){
+  if(!tiling->is_tuning){
+    return 0;
+  }
+  const double wtime = timer() - tiling->tic;
+  double * wtimes = tiling->wtimes;
+  size_t cand = tiling->cand;
+  wtimes[cand] = wtime < wtimes[cand] ? wtime : wtimes[cand];
+  tiling->nsamples += 1;
+  if(NSAMPLES != tiling->nsamples){
+    return 0;
+  }
+  // move on to the next candidate
+  tiling->nsamples = 0;
+  cand += 1;
+  tiling->cand = cand;
+  if(tiling->ncands != cand){
+    return 0;
+  }
+  // all examined, adopt the fastest one
+  size_t best = 0;
+  for(size_t n = 1; n < tiling->ncands; n++){
+    if(wtimes[n] < wtimes[best]){
+      best = n;
+    }
+  }
+  tiling->size = tiling->cands[best];
+  tiling->is_tuning = false;
+  report(domain, tiling);
+  return 0;
+}
+
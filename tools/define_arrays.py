@@ -196,6 +196,10 @@ def domain(root):
     gen_1d(dname, "xc",     (+1, +1))
     gen_1d(dname, "dxf",    (+0, +0))
     gen_1d(dname, "dxc",    (+0, +1))
+    gen_1d(dname, "dxfinv", (+0, +0))
+    gen_1d(dname, "dxcinv", (+0, +1))
+    gen_1d(dname, "wxm",    (-1, +0))
+    gen_1d(dname, "wxp",    (-1, +0))
 
 
 def fluid(root):
@@ -213,20 +217,69 @@ def fluid(root):
     gen_nd(dname, "srct",  ((+0, +0), (+0, +0), (+0, +0)))
 
 
+def gen_band(dname, vname, bounds, is_soa=False):
+    # prepare macros for band-packed arrays,
+    #   whose rows are indexed by J (and K)
+    #   and store [branges[row][0] : branges[row][1]] in each row
+    # when is_soa is True, each component is stored separately
+    #   (structure of arrays) and is specified by the last argument N
+    lbound_1 = get_lbound(bounds[0][0])
+    ubound_1 = get_ubound(bounds[0][1], "jsize")
+    lbound_2 = get_lbound(bounds[1][0])
+    ubound_2 = get_ubound(bounds[1][1], "ksize")
+    nitems_1 = get_nitems(lbound_1, ubound_1)
+    jindex = get_index("J", lbound_1)
+    kindex = get_index("K", lbound_2)
+    row_2d = f"({jindex})"
+    row_3d = f"({jindex}) + (jsize{nitems_1}) * ({kindex})"
+    text = str()
+    for ndims, row, args, extent in (
+            (2, row_2d, "I, J", f"[{lbound_1} : {ubound_1}]"),
+            (3, row_3d, "I, J, K", f"[{lbound_1} : {ubound_1}], [{lbound_2} : {ubound_2}]"),
+    ):
+        text += f"#if NDIMS == {ndims}\n"
+        if "band" == vname:
+            # row-wise information
+            rargs = args.replace("I, ", "")
+            text += (
+                f"// {extent}\n"
+                f"#define BRANGES({rargs}) (branges[{row}])\n"
+                f"#define BOFFSETS({rargs}) (boffsets[{row}])\n"
+                f"#define BAND_NADDS (int [NDIMS][2]){{"
+                f" {{0, 0}},"
+                f" {{{bounds[0][0]}, {bounds[0][1]}}},"
+                + (f" {{{bounds[1][0]}, {bounds[1][1]}}}," if 3 == ndims else "")
+                + f" }}\n"
+            )
+        elif is_soa:
+            text += (
+                f"// [branges[row][0] : branges[row][1]], {extent}, band-packed, SoA\n"
+                f"#define {vname.upper()}({args}, N)"
+                f" ({vname}[(N)][boffsets[{row}] + (I) - branges[{row}][0]])\n"
+            )
+        else:
+            text += (
+                f"// [branges[row][0] : branges[row][1]], {extent}, band-packed\n"
+                f"#define {vname.upper()}({args})"
+                f" ({vname}[boffsets[{row}] + (I) - branges[{row}][0]])\n"
+            )
+        text += (
+            f"#endif\n"
+            f"\n"
+        )
+    output(dname, vname, text)
+
+
 def interface(root):
     dname = f"{root}/interface"
     os.system(f"rm {dname}/*.h")
-    gen_nd(dname, "ifrcx",  ((-1, +0), (+0, +0), (+0, +0)))
-    gen_nd(dname, "ifrcy",  ((+0, +0), (+0, +0), (+0, +0)))
-    gen_nd(dname, "ifrcz",  ((+0, +0), (+0, +0), (+0, +0)))
     gen_nd(dname, "vof",    ((+1, +1), (+2, +2), (+2, +2)))
-    gen_nd(dname, "curv",   ((+1, +1), (+1, +1), (+1, +1)))
-    gen_nd(dname, "dvof",   ((+0, +1), (+1, +2), (+1, +2)))
-    gen_nd(dname, "flxx",   ((+0, +1), (+0, +0), (+0, +0)))
-    gen_nd(dname, "flxy",   ((+0, +0), (+0, +1), (+0, +0)))
-    gen_nd(dname, "flxz",   ((+0, +0), (+0, +0), (+0, +1)))
-    gen_nd(dname, "normal", ((+0, +0), (+1, +1), (+1, +1)))
     gen_nd(dname, "src",    ((+0, +0), (+0, +0), (+0, +0)))
+    gen_nd(dname, "dcache", ((+0, +0), (+1, +1), (+1, +1)))
+    gen_band(dname, "band",   ((+1, +1), (+1, +1)))
+    gen_band(dname, "curv",   ((+1, +1), (+1, +1)))
+    gen_band(dname, "normal", ((+1, +1), (+1, +1)), is_soa=True)
+    gen_band(dname, "thinc",  ((+1, +1), (+1, +1)))
 
 
 def statistics(root):